@@ -23,33 +23,119 @@
 ///         5  Call the 'cancelTimer' function in the event that the timer should be
 ///            terminated.  The argument for 'cancelTimer' should be 'startTimer's'
 ///            return value.
-///         6  Up to 'MAX_LIST_PTRS' timers can be executing simultaneously.  'MAX_LIST_PTRS' is
-///            defined in List.h.  The default value can be changed at the user's
-///            discretion; RAM can be freed by its reduction or more timers can be
-///            available by its increase.
+///         6  Any number of timers can be executing simultaneously.
 //////////////////////////////////////////////////////////////////////////////////////
 
-#include <Arduino.h>
-#include <avr/interrupt.h>
 #include "Timer.h"
+#include "TimerHw.h"
 #include <string.h>
 
-extern Timer timer;
+/// The sketch's Timer.  Weak, so that a sketch driving only TimerT objects need
+/// not define one.
+extern Timer timer __attribute__ ((weak));
 
-void inline Timer2ISR ()
+/// log2 of the prescaler division for each Timer/Counter 2 prescaler code accepted
+/// by configTimers.  A tick is 256 << prescalerShift [code] CPU cycles.
+static const uint8_t prescalerShift [8] = {0, 0, 3, 5, 6, 7, 8, 10};
+
+#if TIMER_AUTOSCALE
+/// Find the coarsest prescaler whose interrupts land on every multiple of a number
+/// of ticks.
+/**
+	\param t is a period or timeOut, or several ORed together.
+	\return the prescaler code, 1 to 7; 7 for t = 0.
+*/
+static uint8_t ScaleOf (const timerTime_t t)
+{
+	uint8_t code = 7;
+
+	while (code > 1 && (t & (((timerTime_t) 1 << prescalerShift [code]) - 1)))
+		code--;
+	return code;
+}
+#endif
+
+#if TIMER_TICKLESS
+/// The counter of the tickless clock, described for Timer::NextTick<> () as
+/// TimerHw<> describes the others.
+struct TicklessHw
+{
+	/// The tickless stamp is the whole 16-bit count of Timer/Counter 1.
+	/**
+		\return TCNT1.
+	*/
+	static uint16_t stamp () {return TCNT1;}
+};
+
+/// The counter that drives the default constructed Timer.
+typedef TicklessHw TimerClockHw;
+
+void inline Timer1ISR (const bool overflow)
+{
+	if (overflow)
+		timer._epoch++;
+	timer.NextTick<TimerClockHw> ();
+}
+
+ISR (TIMER1_COMPA_vect)
+{
+	Timer1ISR (false);
+}
+
+ISR (TIMER1_OVF_vect)
 {
-    timer.NextTick();
+	Timer1ISR (true);
 }
 
-ISR (TIMER2_OVF_vect)
+/// Timer/Counter 1 settings for each Timer/Counter 2 prescaler code accepted by
+/// configTimers.  A tick stays 256 * p CPU cycles.  Timer/Counter 1 has no divide
+/// by 32 or 128, so those use the next smaller divisor and more counts per tick.
+/// The margin keeps a compare value at least 64 CPU cycles ahead of the counter.
+static const struct {uint8_t cs, shift, margin;} ticklessClock [8] =
+{
+	{0, 8, 1},		// Stopped.
+	{1, 8, 64},		// p = 1
+	{2, 8, 8},		// p = 8
+	{2, 10, 8},		// p = 32 is 1024 counts of clk/8.
+	{3, 8, 1},		// p = 64
+	{3, 9, 1},		// p = 128 is 512 counts of clk/64.
+	{4, 8, 1},		// p = 256
+	{5, 8, 1}		// p = 1024
+};
+#else
+/// The counter that drives the default constructed Timer.
+typedef TimerHw<2> TimerClockHw;
+
+/// Drives the sketch's Timer.  Weak, so that TIMER_ISR (2, ...) in TimerT.h can
+/// bind the vector to another Timer instead.
+ISR (TIMER2_OVF_vect, __attribute__ ((weak)))
+{
+	if (&timer)
+		timer.clockTick ();
+}
+#endif
+
+#if TIMER_BOUNDED
+static p_timeElement timerHeap [TIMER_HEAP_SIZE];	///< Storage for the default constructed Timer.
+
+/// Hand the heap storage to the first default constructed Timer only.
+/**
+	\return the capacity of the storage the first time, then 0.
+*/
+static uint16_t ClaimHeap ()
 {
-    Timer2ISR ();
+	static bool claimed = false;
+	uint16_t size = claimed ? 0 : sizeof (timerHeap) / sizeof (timerHeap [0]);
+
+	claimed = true;
+	return size;
 }
+#endif
 
 /// The interrupt service routine calls the timer.NextTick () member function each
 /// time Timer/Counter 2 overflows.  NextTick () increments presentTime, executes
 /// timeElement.clockAlarm () for each timer that expired, updateTimeOut () each
-/// expired timer, and inserts the timer back into the sorted timerList.
+/// expired timer, and inserts the timer back into the sorted queue.
 /// timeElement.clockAlarm () executes the timerCallBack function specified by
 /// the user in timeElement.setCallBack ().
 /**
@@ -59,6 +145,17 @@ ISR (TIMER2_OVF_vect)
 bool timeElement::clockAlarm ()
 {
 	callFunction ();
+	return countRepeat ();
+}
+
+/// Count one expiration against _repeats.  clockAlarm () and deferred timers,
+/// whose callback runs later, both count here when the timer expires.
+/**
+	\return true if more repetitions are needed or false if the timer needs
+			  canceled.
+*/
+bool timeElement::countRepeat ()
+{
 	if (0 != _repeats)		// _repeats == 0 means ad infinitum so don't change.
 		if (0 == --_repeats)
 			return false;		// timer expired for the last time.
@@ -67,13 +164,17 @@ bool timeElement::clockAlarm ()
 
 /// Each time the timer expires this function adds the timePeriod to the timeOut
 /// time.  This sets the timer to expire again when presentTime catches up to
-/// timeOut again.  All of the time registers roll over from 0x7fff to 0.
+/// timeOut again.  All of the time registers roll over from 0xFFFFFFFF to 0.
 /**
     \return The timer's new timeOut time.
 */
-int16_t timeElement::updateTimeOut ()
+timerTime_t timeElement::updateTimeOut ()
 {
-	return _timeOut = (_timePeriod + _timeOut) & 0x7fff;
+#if TIMER_SLACK
+	_timeOut -= _offset;		// The period counts from where the timer was due.
+	_offset = 0;
+#endif
+	return _timeOut += _timePeriod;
 }
 
 /// Copy and assign a timeElement.
@@ -83,181 +184,1367 @@ int16_t timeElement::updateTimeOut ()
 */
 timeElement & timeElement::operator= (timeElement &s)
 {
+	// The queue position belongs to this object.
+#if TIMER_ENGINE == TIMER_ENGINE_HEAP
+	uint16_t heapIndex = _heapIndex;
+#else
+	timeElement *next = _next, **pprev = _pprev;
+#endif
+	Timer *owner = _owner;
+#if TIMER_AUTOSCALE
+	uint8_t scale = _scale;
+#endif
+
 	memcpy (this, &s, sizeof (timeElement));
+#if TIMER_ENGINE == TIMER_ENGINE_HEAP
+	_heapIndex = heapIndex;
+#else
+	_next = next;
+	_pprev = pprev;
+#endif
+	_owner = owner;
+#if TIMER_AUTOSCALE
+	_scale = scale;
+#endif
+#if TIMER_CAPTURE_SIZE
+	if (s._arg == s._capture)
+		_arg = _capture;		// Call our own copy of the lambda.
+#endif
 	return *this;
 }
 
+/// Replace the timer's timeout period.  The next expiration of a running timer
+/// becomes the previous expiration (or start) plus the new period, and the timer
+/// moves to its new place in the queue.
+/**
+	\param p is the new value of the timeout period.
+*/
+void timeElement::modifyPeriod (timerTime_t p)
+{
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+#if TIMER_SLACK
+		_timeOut -= _offset;
+		_offset = 0;
+#endif
+		_timeOut += p - _timePeriod;
+		_timePeriod = p;
+		if (isRunning ())
+			_owner->rescheduleTimer (this, _timeOut);
+	}
+}
+
+/// Replace the timeout time for the timer and move a running timer to its new
+/// place in the queue.
+/**
+	\param to is the new value of the timeout time for the timer.
+*/
+void timeElement::modifyTimeOut (timerTime_t to)
+{
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		if (isRunning ())
+			_owner->rescheduleTimer (this, to);
+		else
+			_timeOut = to;		// Not queued, or re-queued when its callback returns.
+	}
+}
+
 /// Configure the hardware to divide processor clock by 1, to interrupt the processor
 /// when the counter register overflows from 0xFF to 0x00, and to enable interrupts.
-/// Also, tag all elements in List as available.
+/// The queue starts empty.
 ///
 /// By changing the prescaler and interrupt mode, the user has a great deal of control
 /// over the timers' resolution and duration.  Such detailed control requires code
 /// changes, but the prescaler can be changed using configTimers.
 /// \sa configTimers
 Timer::Timer()
+#if TIMER_ENGINE == TIMER_ENGINE_HEAP
+	: _queue (timerHeap, ClaimHeap ())
+#endif
 {
+	_presentTime = 0;
+	_current = 0;
+	_due = 0;
+	_fired = 0;
+	_ownsClock = true;
+	_stamp = TimerClockHw::stamp;
+#if !TIMER_TICKLESS
+	_countShift = 0;	// Prescaler division 1.
+	_era = 0;
+	_lead = 0;
+#endif
+#if TIMER_AUTOSCALE
+	_prescaler = 7;		// No timers yet:  the coarsest division.
+	_target = 7;
+	_residue = 0;
+	memset (_running, 0, sizeof (_running));
+#endif
+#if TIMER_STATS
+	_stats.Reset ();
+#endif
+
+#if TIMER_TICKLESS
+	_epoch = 0;
+	_tickShift = 8;
+	configTimers (1);					// Normal mode, prescaler division 1.
+	TIMSK1 = 1 << TOIE1;				// Compare match A is enabled when a timer is due.
+#else
     // Configure hardware timer for interrupt and default prescaler.
     TCCR2A = 0x00;  // Disable waveform generation and frequency construction.
+#if TIMER_AUTOSCALE
+    TCCR2B = _prescaler;
+#else
     TCCR2B = 0x01;  // Set prescaler division to 1.
+#endif
     TIMSK2 = 0x01;  // Enable interrupt on timer overflow.
+#endif
 }
 
 ///
-/// Disable the interrupt for timer 2.
+/// Disable the interrupt for timer 2 (timer 1 when tickless).  A Timer constructed
+/// by TimerT leaves its hardware to TimerT.
 ///
 Timer::~Timer()
 {
+	if (!_ownsClock)
+		return;
+#if TIMER_TICKLESS
+	TIMSK1 = 0;
+#else
     TIMSK2 = 0;  // Disable timer interrupt.
+#endif
+}
+
+/// Empty the queue for a Timer whose hardware is configured by a derived class,
+/// as TimerT does.
+/**
+	\param heap points to the heap storage; ignored by the list and wheel.
+	\param capacity is the number of timers heap holds.
+	\param stamp reads the hardware counter.
+	\param countShift is log2 of the prescaler division:  CPU cycles per count.
+*/
+Timer::Timer (p_timeElement *heap, uint16_t capacity, uint16_t (*stamp) (), uint8_t countShift)
+#if TIMER_ENGINE == TIMER_ENGINE_HEAP
+	: _queue (heap, capacity)
+#endif
+{
+#if !TIMER_BOUNDED
+	(void) heap;			// The list and wheel are unbounded.
+	(void) capacity;
+#endif
+	_presentTime = 0;
+	_current = 0;
+	_due = 0;
+	_fired = 0;
+	_ownsClock = false;
+	_stamp = stamp;
+	_countShift = countShift;
+#if !TIMER_TICKLESS
+	_era = 0;
+	_lead = 0;
+#endif
+#if TIMER_AUTOSCALE
+	_prescaler = 7;		// TimerT refuses TIMER_AUTOSCALE; kept consistent all the same.
+	_target = 7;
+	_residue = 0;
+	memset (_running, 0, sizeof (_running));
+#endif
+#if TIMER_STATS
+	_stats.Reset ();
+#endif
+}
+
+/// Count one tick of the hardware timer that drives this Timer.  The default
+/// Timer/Counter 2 ISR calls it; TimerT's clockTick () runs the same code compiled
+/// for its own counter.
+void Timer::clockTick ()
+{
+	NextTick<TimerClockHw> ();
 }
 
 /// Start another timer to callback a user's function with the user's parameters at user-defined
 /// intervals for a user-defined number of times.
 /**
     \param pArg a pointer to a timer structure that the user has filled with desired timer properties.
+    \return false if the queue is full and the timer was not started.
     \sa timeElement, cancelTimer, modifyTimer
 */
-void Timer::startTimer (p_timeElement pArg)
+bool Timer::startTimer (p_timeElement pArg)
+{
+	bool started;
+
+	// A tick between reading _presentTime and inserting would put the timer behind
+	// the clock, so both happen with interrupts disabled.
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		pArg->setTimeOut (Now () + pArg->getTimePeriod ()); // Set the expiration time.
+
+		// Keeping the queue sorted saves the interrupt service routine from needing
+		// to check every timer for expiration; if the head has not expired, then none
+		// have.
+		started = InsertTimer (pArg);
+#if TIMER_TICKLESS
+		ArmCompare ();		// The new timer might be due before the armed one.
+#endif
+	}
+	return started;
+}
+
+/// Start a group of timers together.  The first expiration of every timer is its
+/// phase plus its period after the same present tick, and the whole group goes
+/// into the queue in one critical section, so the timers stay phase-locked however
+/// long the call takes.  A timer already running is restarted.
+/**
+	\param te points to n timeElements, each with its period and callback set.
+	\param n is the number of timers.
+	\param phase points to n phases in ticks, or is 0 for none.
+	\return the number of timers started; fewer than n only if the queue filled.
+	\sa startTimer, cancelTimers
+*/
+uint8_t Timer::startTimers (const p_timeElement te, const uint8_t n, const timerTime_t *phase)
 {
-	pArg->setTimeOut (_presentTime + pArg->getTimePeriod ()); // Set the expiration time.
+	uint8_t started;
 
-	// Search the _timeOutList for correct insertion point to keep the list sorted.
-	// This saves the interrupt service routine from needing to check every timer
-	// for expiration; if timer[0] has not expired, then none have because the list
-	// is sorted.
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		timerTime_t now = Now ();
 
-	InsertTimer (pArg);
+		for (uint8_t i=0; i<n; i++)
+			te [i]._timeOut = (phase ? phase [i] : 0) + te [i]._timePeriod;
+
+		for (uint8_t i=0; i<n; i++)
+			te [i]._timeOut += now;
+		started = InsertTimers (te, n);
+#if TIMER_TICKLESS
+		ArmCompare ();
+#endif
+	}
+	return started;
 }
 
-/// Remove a specific timer from List and prevent additional alarms it might have caused.
+/// Move a timer's next expiration to a new time, or start a timer that is not
+/// running so that it first expires then.  The timer keeps its period, repeats
+/// and callback.  A timeOut that is not after the present time expires at the
+/// next tick.
+/**
+	\param pTE points to the timer to be rescheduled.
+	\param timeOut is the value of presentTime at which the timer will expire.
+	\return false if the queue is full and the timer was not started.
+	\sa startTimer, timeElement.modifyTimeOut
+*/
+bool Timer::rescheduleTimer (const p_timeElement pTE, const timerTime_t timeOut)
+{
+	bool queued;
+
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		timerTime_t now = Now ();
+
+		pTE->_timeOut = timerBefore (now, timeOut) ? timeOut : now + 1;
+		queued = InsertTimer (pTE);
+#if TIMER_TICKLESS
+		ArmCompare ();
+#endif
+	}
+	return queued;
+}
+
+/// Remove a specific timer from the queue and prevent additional alarms it might
+/// have caused.  The timer unlinks itself, so this takes the same time however
+/// many timers are running.  Canceling a timer that is not running does nothing.
 /**
     \param pTE A reference to the timer to be canceled.
     \sa startTimer, modifyTimer
 */
 void Timer::cancelTimer (const p_timeElement pTE)
 {
-    uint8_t i;
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		if (_current == pTE)
+			_current = 0;		// Canceled from its own callback; do not re-insert.
+		_queue.Remove (pTE);
+#if TIMER_DEFER
+		pTE->_pending = 0;	// dispatch () skips it.
+#endif
+#if TIMER_AUTOSCALE
+		Release (pTE);
+#endif
+#if TIMER_TRACE
+		Trace (TIMER_TRACE_CANCEL, pTE, 0, _stamp ());
+#endif
+	}
+}
 
-    // First, find the timer.
-    for (i=0; i<_timeOutList.GetCount (); i++)
-        if (static_cast<p_timeElement>((void *)_timeOutList[i]) == pTE)
-            break;
+#if TIMER_STAGE
+/// Hand changes to a timer to the ISR, which applies them together at its next
+/// tick and moves the timer to its new place in the queue.  Interrupts stay
+/// enabled.  Call from loop () only; a callback should use the modifyXxxx ()
+/// functions instead.
+/**
+	\param u describes the timer and the fields to change.
+	\return false if TIMER_STAGE_SIZE updates are already waiting and u was not staged.
+	\sa timerUpdate_t
+*/
+bool Timer::stageUpdate (const timerUpdate_t &u)
+{
+	return _stageQueue.Push (u);
+}
 
-    _timeOutList.Remove (i); // Remove the timer from the list.
+#endif
+/// Cancel a group of timers in one critical section, so no tick sees part of the
+/// group stopped.  Timers that are not running are skipped.
+/**
+	\param te points to n timeElements.
+	\param n is the number of timers.
+	\sa cancelTimer, startTimers
+*/
+void Timer::cancelTimers (const p_timeElement te, const uint8_t n)
+{
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		for (uint8_t i=0; i<n; i++)
+			cancelTimer (&te [i]);
+	}
 }
 
-/// Change the prescaler division of all timers.
+/// Call this from loop () to run the callbacks of deferred timers.  Each queued
+/// timer's callback is called once for every expiration counted since the last
+/// dispatch, in the order the timers first expired, with interrupts enabled.  A
+/// timer canceled meanwhile is skipped.  Without TIMER_DEFER nothing is deferred
+/// and dispatch () returns at once.
 /**
-    \param prescaler The value written to the three lsb of TCCR2B.
-    \sa Datasheet for your processor.  Reference TCCR2B.
+	\return the number of callbacks executed.
+	\sa timeElement.setDeferred
 */
-void Timer::configTimers (const uint8_t prescaler)
+uint8_t Timer::dispatch ()
 {
-    TCCR2B = prescaler & 0x07;
+	uint8_t n = 0;
+#if TIMER_DEFER
+	p_timeElement pTE;
+
+	while (_deferQueue.Pop (pTE))
+	{
+		uint8_t pending;
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		{
+			pending = pTE->_pending;
+			pTE->_pending = 0;
+		}
+		for ( ; pending > 0; pending--, n++)
+			pTE->callFunction ();
+	}
+#endif
+	return n;
 }
 
-/// Since the values of _presentTime and _timeOut roll over at 0x7FFF
-/// it is difficult to compare two _timeOuts so that they can be sorted
-/// into increasing order.  After all, if _presentTime > _timeOut_a, then
-/// _presentTime must finish its count to 0x7FFF, roll over to 0, and
-/// increase again to _timeOut before the alarm will execute; this is
-/// much farther in the future than another timeout whose value has
-/// _timeOut_b > _presentTime despite the fact that
-/// _timeOut_a < _presentTime < _timeOut_b would yield the wrong
-/// result.  The solution I have chosen is to reserve the most
-/// significant bit of the word for the case when _presentTime > _timeOut_a
-/// to make _timeOut_a + 0x8000 > _timeOut_b as it should be.
+/// Subtract the ticks the clock has run since _presentTime, when tickless, from the
+/// ticks TicksToNext () counts from there.  The wheel reports the next tick at which
+/// it has work, which may come before any timer is actually due, so its answer is
+/// a lower bound.
 /**
-	\param time is the value to be normalized.
-	\return normalized value of presentTime when alarm will execute.
+	\return the ticks until the next timer is due, 0 if one is due now, or
+			 0xFFFFFFFF if no timer is running.
 */
-uint16_t Timer::normalizeTimeOut (const uint16_t time) const
+timerTime_t Timer::ticksUntilNextTimer ()
 {
-	uint16_t t;
-	uint8_t __sreg = SREG;
-	noInterrupts ();
+	timerTime_t ticks;
+
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		timerTime_t lag = Now () - _presentTime;
 
-	if (_presentTime > time) t = time | 0x8000;
-	else t = time;
+		ticks = TicksToNext ();
+		if (0 == ticks)
+			ticks = 0xFFFFFFFF;
+		else if (ticks > lag)
+			ticks -= lag;
+		else
+			ticks = 0;
+	}
+	return ticks;
+}
 
-	SREG = __sreg;
+/// Sleep in the mode given by SleepMode () until the ISR has called back a timer.
+/// Every other interrupt wakes the processor too, and it goes back to sleep.  With
+/// no timer running, the first interrupt ends the wait.  A deferred timer that is
+/// waiting for dispatch () ends it as well, so call dispatch () after this.
+/// Interrupts are enabled on return.
+void Timer::idleUntilNextTimer ()
+{
+	uint8_t fired = _fired;
 
-	return t;
+	set_sleep_mode (SleepMode ());
+	for (;;)
+	{
+		cli ();
+#if TIMER_DEFER
+		if (0 != _deferQueue.GetCount ())
+			break;
+#endif
+		sleep_enable ();
+		sei ();					// The instruction after sei () runs before any interrupt,
+		sleep_cpu ();			// so a wake-up cannot be lost in between.
+		sleep_disable ();
+		if (fired != _fired || 0 == getCount ())
+			break;
+	}
+	sei ();
+}
+
+/// Name the deepest sleep mode that keeps the Timer's counter running.  TimerT
+/// substitutes the mode of its own hardware timer.
+/**
+	\return the mode for set_sleep_mode ().
+*/
+uint8_t Timer::SleepMode () const
+{
+#if TIMER_TICKLESS
+	return TimerHw<1>::sleepMode ();
+#else
+	return TimerHw<2>::sleepMode ();
+#endif
+}
+
+#if !TIMER_AUTOSCALE
+/// Change the prescaler division of all timers.
+/**
+    \param prescaler The value written to the three lsb of TCCR2B.
+    \sa Datasheet for your processor.  Reference TCCR2B.
+*/
+void Timer::configTimers (const uint8_t prescaler)
+{
+#if TIMER_TICKLESS
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		// Re-express the present tick in counts of the new clock.
+		timerTime_t t = HardwareTime ();
+
+		_tickShift = ticklessClock [prescaler & 0x07].shift;
+		_margin = ticklessClock [prescaler & 0x07].margin;
+		TCCR1A = 0x00;		// Normal mode.
+		TCCR1B = ticklessClock [prescaler & 0x07].cs;
+		TCNT1 = t << _tickShift;
+		_epoch = t >> (16 - _tickShift);
+		TIFR1 = 1 << TOV1;	// The overflow is accounted for in _epoch.
+		_countShift = 8 + prescalerShift [prescaler & 0x07] - _tickShift;
+		ArmCompare ();
+	}
+#else
+    TCCR2B = prescaler & 0x07;
+	_countShift = prescalerShift [prescaler & 0x07];
+#endif
 }
+#endif // !TIMER_AUTOSCALE
 
 /// The NextTick () function is called by the interrupt service routine each time
 /// Timer/Counter 2 overflows.  NextTick () increments presentTime, calls
 /// timeElement.clockAlarm () for each expired timer, and re-inserts the timer
-/// into the sorted timerList if another alarm is indicated.  NextTick () should
+/// into the sorted queue if another alarm is indicated.  NextTick () should
 /// ONLY be called by the ISR if the clock is to keep correct time.  Since this
 /// is part of an ISR, interrupts are already disabled.
+///
+/// NextTick () and the functions it calls are templates of the counter, Hw, so that
+/// the ISR compiled for each counter reads and acknowledges it directly.
+///
+/// The flag of an overflow that comes while the ISR runs holds one interrupt
+/// only.  Fire () takes it after each callback and counts the tick in _lead, and
+/// NextTick () expires the ticks so counted before it returns.  Overflows lost to
+/// interrupts disabled elsewhere for two ticks or more cannot be recovered.
+///
+/// When tickless, the ISR runs only when a timer is due or Timer/Counter 1
+/// overflows.  NextTick () then catches presentTime up to the counter, expires
+/// every timer due by then, and arms the compare match for the next one.
+///
+/// Under TIMER_AUTOSCALE each interrupt is as many ticks as the prescaler division,
+/// and the ticks are stepped through in the same way.  The prescaler is then made
+/// coarser if the timers left running allow.
+///
+/// Updates staged by loop () (TIMER_STAGE) are applied first, so the timers they
+/// move expire this tick if due.
 /**
     \sa timeElement, timeElement.clockAlarm
 */
-inline void Timer::NextTick ()
+template <class Hw>
+void Timer::NextTick ()
 {
-	_presentTime = (_presentTime + 1) & 0x7fff;  // Add one tick to clock.
+#if TIMER_STATS
+	uint16_t entry = Hw::stamp ();
+	timerTime_t before = _presentTime;
+#endif
+#if TIMER_STAGE
+	Commit ();
+#endif
+#if TIMER_TICKLESS
+	Advance<Hw> (HardwareTime ());
+	ArmCompare ();
+#elif TIMER_AUTOSCALE
+	_lead += (timerTime_t) 1 << prescalerShift [_prescaler];	// The ticks of this interrupt.
+	while (_lead)		// Ticks taken while the timers were called back go round again.
+	{
+		timerTime_t now = _presentTime + _lead;
 
-	if (0 == getCount ()) return;		// No timers.
+		if (now < _presentTime)
+			_era++;
+		_lead = 0;
+		Advance<Hw> (now);
+	}
+	Rescale ();
+#else
+	_lead++;			// The tick of this interrupt.
+	while (_lead)		// Ticks taken while the timers were called back go round again.
+	{
+		_lead--;
+		if (0 == ++_presentTime)  // Add one tick to clock.
+			_era++;
+		Expire<Hw> (_presentTime);
+	}
+#endif
+#if TIMER_STATS
+	uint16_t done = Hw::stamp ();
+
+	_stats.ticks += _presentTime - before;
+	_stats.isrCounts += (uint16_t) (done - entry);
+	if ((uint16_t) (done - TickStamp (_presentTime)) >= CountsPerTick ())
+		_stats.overruns++;		// The next tick began before the ISR returned.
+#endif
+#if TIMER_TRACE
+	uint16_t stamp = Hw::stamp ();
+
+	if ((uint16_t) (stamp - TickStamp (_presentTime)) >= CountsPerTick ())
+		Trace (TIMER_TRACE_LOST, 0, 0, stamp);
+#endif
+}
+
+#if TIMER_TICKLESS || TIMER_AUTOSCALE
+/// Bring presentTime up to a tick that may lie several ticks ahead and expire every
+/// timer due by then.  The wheel is stepped from one non-empty slot to the next on
+/// the way.  Called by NextTick () only.
+/**
+	\param now is the tick the counter has reached.
+*/
+template <class Hw>
+inline void Timer::Advance (const timerTime_t now)
+{
+#if TIMER_ENGINE == TIMER_ENGINE_WHEEL
+	timerTime_t next, lag = now - _presentTime;
+
+	while (0 != (next = TicksToNext ()) && next <= lag)
+	{
+		_queue.Skip (next - 1);
+		_presentTime += next;
+		lag -= next;
+		Expire<Hw> (now);
+	}
+	_queue.Skip (lag);
+#endif
+	_presentTime = now;
+#if TIMER_ENGINE != TIMER_ENGINE_WHEEL
+	Expire<Hw> (now);
+#endif
+}
+
+#endif
+#if TIMER_STAGE
+/// Apply the updates staged since the last tick, in the order they were staged.
+/// The period goes before the timeOut, so an update that sets both ends with the
+/// timeOut given.  Called by NextTick () only, before any timer expires.
+inline void Timer::Commit ()
+{
+	timerUpdate_t u;
 
-	// Check for expired timers.
-	while (_presentTime == GET_TIMEOUT (0))
+	while (_stageQueue.Pop (u))
 	{
-		// Update the timed out timers... one timer each time through while loop.
-		static_cast<p_timeElement>(_timeOutList[0])->updateTimeOut ();
-
-		// Execute the CallBack function.
-		static_cast<p_timeElement>(_timeOutList[0])->clockAlarm ();
-
-		// Sort the list.
-		for (uint8_t i=1; i < _timeOutList.GetCount (); i++)
-			if (normalizeTimeOut (GET_TIMEOUT (i-1)) > normalizeTimeOut (GET_TIMEOUT (i)))
-				_timeOutList.Swap (i-1, i);
-			else
-				break;
+		if (u.fields & timerUpdate_t::REPEATS)
+			u.timer->_repeats = u.repeats;
+		if (u.fields & timerUpdate_t::CALLBACK)
+			u.timer->setCallBack (u.callBack, u.arg);
+		if (u.fields & timerUpdate_t::PERIOD)
+			u.timer->modifyPeriod (u.period);
+		if (u.fields & timerUpdate_t::TIMEOUT)
+			u.timer->modifyTimeOut (u.timeOut);
 	}
 }
 
-/// Insert timer with pointer pArg into _timerList at the location that keeps the list
-/// sorted in increasing timeout time order.  This function is for internal use only.
+#endif
+/// Call back every timer due by now, update its timeOut and put it back in the
+/// queue.  The sorted queue hands over all the due timers at once and takes the
+/// survivors back in one merge when they have all run, so k timers expiring
+/// together cost O(k log k + n) rather than O(k * n).  The merge may leave timers
+/// due again (TIMER_CATCHUP), which are handled in another round.  Called by
+/// NextTick () only.
+/**
+	\param now is the present time; when the wheel steps through past ticks,
+			 _presentTime is the tick being processed.
+*/
+template <class Hw>
+inline void Timer::Expire (const timerTime_t now)
+{
+	p_timeElement pTE;
+
+#if TIMER_ENGINE == TIMER_ENGINE_WHEEL
+	// The wheel hands over the timers due at this tick, and any overdue.
+	_queue.Expire ();
+	while (0 != (pTE = _queue.Pop ()))
+		Fire<Hw> (pTE, now);
+#elif TIMER_ENGINE == TIMER_ENGINE_LIST
+	do
+	{
+		_queue.Expire (now);
+		while (0 != (pTE = _queue.Pop ()))
+			Fire<Hw> (pTE, now);
+	} while (_queue.Merge (now));
+#else
+	// The due timers are at the root of the heap.
+	while (0 != (pTE = _queue.Pop (now)))
+		Fire<Hw> (pTE, now);
+#endif
+	_current = 0;
+}
+
+/// Update the timeOut of an expired timer, call it back and queue it again.  A
+/// timer whose next deadline has passed as well is handled according to its
+/// overrun policy:  TIMER_CATCHUP leaves the deadline to fire again, TIMER_RESYNC
+/// moves it one period past now, and TIMER_SKIP moves it to the first deadline of
+/// its schedule after now.  A timer with a period of 0 would be due again at
+/// once under any policy; it fires once each tick instead.  The timer stops once
+/// Alarm () returns false, after its last repetition.  Called by Expire () only.
 /**
-	\param pArg is a pointer to the timerElement that needs inserted into the list.
+	\param pTE points to the expired timer, already out of the queue.
+	\param now is the present time.
 */
-void Timer::InsertTimer (const p_timeElement pArg)
+template <class Hw>
+inline void Timer::Fire (const p_timeElement pTE, const timerTime_t now)
 {
-	uint8_t __sreg = SREG;
+	timerTime_t due = pTE->_timeOut;
+	timerTime_t next = pTE->updateTimeOut ();
 
-	if (_timeOutList.GetCount () > 0)
+	if (0 == pTE->_timePeriod)
+		pTE->_timeOut = now + 1;
+	else if (!timerBefore (now, next) && TIMER_CATCHUP != pTE->_overrun)
 	{
-		_timeOutList.InsertAt (Search (pArg), (pObject) pArg); // Re-insert into List.
+		timerTime_t period = pTE->_timePeriod;
+
+		if (TIMER_RESYNC == pTE->_overrun)
+			pTE->_timeOut = now + period;
+		else
+			pTE->_timeOut += ((now - pTE->_timeOut) / period + 1) * period;
+	}
+	_current = pTE;
+	_due = due;
+	_fired = (uint8_t) (_fired + 1);	// C++20 deprecates ++ on a volatile.
+#if TIMER_TRACE
+	Trace (TIMER_TRACE_FIRE, pTE, now - due < 0xFF ? now - due : 0xFF, Hw::stamp ());
+#endif
+#if TIMER_STATS
+	uint16_t start = Hw::stamp ();
+	bool again = Alarm (pTE);
+
+	pTE->_stats.Record (start - TickStamp (due), Hw::stamp () - start);
+#else
+	bool again = Alarm (pTE);
+#endif
+#if TIMER_TRACE
+	Trace (TIMER_TRACE_END, pTE, again, Hw::stamp ());
+#endif
+#if TIMER_AUTOSCALE
+	if (Hw::takeTick ())
+		_lead += (timerTime_t) 1 << prescalerShift [_prescaler];
+#elif !TIMER_TICKLESS
+	if (Hw::takeTick ())
+		_lead++;			// NextTick () expires it before returning.
+#endif
+
+	// Re-queue unless finished, or the callback canceled or restarted the timer.
+	if (again && _current == pTE && !_queue.Contains (pTE))
+	{
+#if TIMER_AUTOSCALE
+		Claim (pTE);		// RESYNC and a period of 0 move the timeOut off its ticks.
+#endif
+#if TIMER_SLACK
+		Align (pTE);
+#endif
+#if TIMER_ENGINE == TIMER_ENGINE_LIST
+		_queue.Hold (pTE);
+#else
+		_queue.Insert (pTE);
+#endif
 	}
-	else
-		_timeOutList.Add ((pObject) pArg);
+#if TIMER_AUTOSCALE
+	else if (!_queue.Contains (pTE))
+		Release (pTE);		// Finished, or canceled by its callback.
+#endif
+}
 
-	SREG = __sreg;
+/// Execute the CallBack function of an expired timer, or, if the timer is deferred,
+/// queue it for dispatch () and count the expiration.  A timer already queued is
+/// not queued twice; dispatch () calls it once per counted expiration.  Called by
+/// Expire () only.
+/**
+	\param pTE points to the expired timer.
+	\return the value of clockAlarm ():  false after the last repetition.
+*/
+inline bool Timer::Alarm (const p_timeElement pTE)
+{
+#if TIMER_DEFER
+	if (pTE->_deferred && (0 != pTE->_pending || _deferQueue.Push (pTE)))
+	{
+		if (pTE->_pending < 0xff)
+			pTE->_pending = (uint8_t) (pTE->_pending + 1);
+		return pTE->countRepeat ();
+	}
+#endif
+	return pTE->clockAlarm ();		// Not deferred, or the queue is full.
 }
 
-/// Find the position to insert pArg into _timeOutList so that the list remains sorted
-/// _timeOutList[0] will timeout first, _timeOutList[1] will timeout second, ...
-/// This function is for internal use only.
+/// Request the number of ticks from _presentTime until a timer needs attention.
+/// For the wheel this is the next tick that expires or cascades a non-empty slot,
+/// which may come before any timer is actually due.
 /**
-	\param pArg is a pointer to the timeElement that needs inserted into the list.
-	\return the smallest index of timeElements having larger timeouts than pArg.
+	\return at least 1 tick, or 0 if no timer is running.
 */
-uint8_t Timer::Search (const p_timeElement pArg)
+timerTime_t Timer::TicksToNext ()
 {
-	if (0 == _timeOutList.GetCount ())
+#if TIMER_ENGINE == TIMER_ENGINE_WHEEL
+	if (0 == _queue.GetCount ())
 		return 0;
+	return _queue.Idle () + 1;
+#else
+	if (0 == getCount ())
+		return 0;
+	timerTime_t to = _queue.Head ()->getTimeOut ();
+
+	return timerBefore (_presentTime, to) ? to - _presentTime : 1;	// Overdue needs the next tick.
+#endif
+}
+
+#if TIMER_TICKLESS
+/// Read TCNT1 together with the overflow count that extends it.  An overflow whose
+/// interrupt is still pending has already happened, so it is counted here too.
+/// Call with interrupts disabled.
+/**
+	\param epoch receives the number of overflows, the high words of the count.
+	\return the low word of the count, TCNT1.
+*/
+uint16_t Timer::HardwareCount (uint32_t &epoch) const
+{
+	uint16_t count = TCNT1;
+
+	epoch = _epoch;
+	if ((TIFR1 & (1 << TOV1)) && count < 0x8000)
+		epoch++;
+	return count;
+}
+
+/// Reconstruct the present tick from the hardware count.  Call with interrupts
+/// disabled.
+/**
+	\return the present tick.
+*/
+timerTime_t Timer::HardwareTime () const
+{
+	uint32_t epoch;
+	uint16_t count = HardwareCount (epoch);
+
+	return (epoch << (16 - _tickShift)) | (count >> _tickShift);
+}
+#endif // TIMER_TICKLESS
+
+/// Request the presentTime of the interrupt clock.  The 32-bit clock cannot be
+/// read in one instruction, so it is read with interrupts disabled.
+/**
+	\return the present tick.
+*/
+timerTime_t Timer::getPresentTime () const
+{
+	timerTime_t t;
+
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		t = Now ();
+	return t;
+}
+
+/// Read the clock to the count of the hardware counter:  presentTime times the
+/// counts in a tick, plus the counts since the tick began.  A tick whose interrupt
+/// is still pending is counted, so the reading never steps backwards.
+/**
+	\return the counts since the Timer started, modulo 2^32.
+	\sa millis, micros
+*/
+uint32_t Timer::now () const
+{
+	uint32_t counts;
+
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		counts = Counts ();
+	return counts;
+}
+
+/// Request the microseconds since the Timer started, as the Arduino core's micros ()
+/// does.  The resolution is one count of the hardware counter.
+///
+/// Ticked, the clock counts overflows, and the flag of a pending overflow holds only
+/// one.  A sketch that keeps interrupts disabled for longer than a tick (256 CPU
+/// cycles, 16 us at 16 MHz, at the default prescaler) may lose every overflow but
+/// one in that window, and micros () and millis () then fall behind for good.  The
+/// ISR's own callbacks lose none (see NextTick ()).  Keep such windows shorter than
+/// a tick, choose a prescaler whose tick outlasts them, or define TIMER_TICKLESS,
+/// whose clock is the hardware counter.
+/**
+	\return the microseconds, modulo 2^32.
+*/
+uint32_t Timer::micros () const
+{
+	return Microseconds ();
+}
+
+/// Request the milliseconds since the Timer started, as the Arduino core's millis ()
+/// does.  The microseconds are divided by 1000 in 32-bit halves, since 2^32 is
+/// 4294967 * 1000 + 296.  Ticked, the clock loses ticks while interrupts stay
+/// disabled for longer than a tick; see micros ().
+/**
+	\return the milliseconds, modulo 2^32.
+*/
+uint32_t Timer::millis () const
+{
+	uint64_t us = Microseconds ();
+	uint32_t hi = us >> 32, lo = us;
+
+	return hi * 4294967UL + lo / 1000 + (hi * 296UL + lo % 1000) / 1000;
+}
+
+/// Wait for a number of milliseconds, as the Arduino core's delay () does.  While a
+/// whole tick remains the processor sleeps, to be woken by the tick; when tickless,
+/// or for the last tick, it waits awake.  Timers keep running meanwhile.  Call from
+/// loop (), not from a callback.
+/**
+	\param ms is the number of milliseconds to wait.
+	\sa elapsed
+*/
+void Timer::delay (uint32_t ms)
+{
+	uint64_t end = Microseconds () + (uint64_t) ms * 1000;
+#if !TIMER_TICKLESS
+	set_sleep_mode (SleepMode ());
+#endif
+	for (;;)
+	{
+		cli ();			// A tick between the test and sleep_cpu () would be slept through.
 
-	uint8_t i, __sreg = SREG;	// Prevent _presentTime changing.
-	noInterrupts ();
+		uint64_t us = Microseconds ();
 
-	for (i=0; i<_timeOutList.GetCount (); i++)
-		if (normalizeTimeOut (pArg->getTimeOut ()) < normalizeTimeOut (GET_TIMEOUT (i)))
+		if (us >= end)
 			break;
+#if !TIMER_TICKLESS
+		if (end - us > TickCycles () / (F_CPU / 1000000UL))
+		{
+			sleep_enable ();
+			sei ();		// sleep_cpu () executes before any interrupt is taken.
+			sleep_cpu ();
+			sleep_disable ();
+			continue;
+		}
+#endif
+		sei ();
+		_NOP ();		// A pending interrupt is taken here, not held off by cli ().
+	}
+	sei ();
+}
+
+/// A delay that does not block.  Asks whether an interval has passed since a mark
+/// and, if it has, moves the mark on by the interval, so that
+///
+///		if (timer.elapsed (last, 100)) ...
+///
+/// in loop () is true every 100 ms without drifting.  Start the mark at millis ().
+/**
+	\param mark is a value of millis ().
+	\param ms is the interval in milliseconds.
+	\return true if ms milliseconds have passed since mark.
+*/
+bool Timer::elapsed (uint32_t &mark, const uint32_t ms) const
+{
+	if (millis () - mark < ms)
+		return false;
+	mark += ms;
+	return true;
+}
+
+/// Read the clock, extended past the wrap of presentTime, in counts of the hardware
+/// counter.  Call with interrupts disabled.
+/**
+	\return the counts since the Timer started.
+*/
+uint64_t Timer::Counts () const
+{
+#if TIMER_TICKLESS
+	uint32_t epoch;
+	uint16_t count = HardwareCount (epoch);
+
+	return (uint64_t) epoch << 16 | count;
+#elif TIMER_AUTOSCALE
+	// Counted in CPU cycles, which keep their length when the prescaler changes.
+	return (((((uint64_t) _era << 32) | _presentTime) + _lead) << 8) + ((uint32_t) _stamp () << prescalerShift [_prescaler]) + _residue;
+#else
+	// The stamp adds a tick whose interrupt is pending; _lead those already taken.
+	return (((((uint64_t) _era << 32) | _presentTime) + _lead) << 8) + _stamp ();
+#endif
+}
+
+/// Convert the clock to microseconds.
+/**
+	\return the microseconds since the Timer started.
+*/
+uint64_t Timer::Microseconds () const
+{
+	uint64_t counts;
+
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		counts = Counts ();
+	return (counts << _countShift) / (F_CPU / 1000000UL);
+}
+
+#if TIMER_TICKLESS
+/// Program compare match A for the tick when the next timer needs attention.  If
+/// that tick lies beyond the present 16-bit count, only the overflow interrupt
+/// stays enabled and the overflow arms the compare later.  A timer already due
+/// gets a compare a few counts ahead so that its interrupt follows at once.  Call
+/// with interrupts disabled.
+void Timer::ArmCompare ()
+{
+	timerTime_t ahead = TicksToNext ();
+
+	TIMSK1 = 1 << TOIE1;
+	if (0 == ahead)
+		return;		// No timers.
+
+	uint32_t epoch;
+	uint16_t now = HardwareCount (epoch);
+	timerTime_t tick = (epoch << (16 - _tickShift)) | (now >> _tickShift);
+
+	timerTime_t lag = tick - _presentTime;	// Ticks the counter is ahead of _presentTime.
+
+	if (ahead > lag + (0x10000UL >> _tickShift))
+		return;		// Not in this count cycle.
+
+	// Counts from now to the due tick; negative if overdue.
+	int32_t counts = (int32_t) (ahead - lag) * (1L << _tickShift) - (now & ((1 << _tickShift) - 1));
+
+	if (counts < _margin)
+		counts = _margin;
+	if (now + counts > 0xffffL)
+		return;		// Not in this count cycle.
+
+	uint16_t due = now + counts;
+
+	// The counter kept running while due was computed.
+	uint16_t count = TCNT1;
+	if (due < (uint32_t) count + _margin)
+	{
+		if ((uint32_t) count + _margin > 0xffff)
+			return;	// The overflow is about to arrive.
+		due = count + _margin;
+	}
+
+	OCR1A = due;
+	TIFR1 = 1 << OCF1A;
+	TIMSK1 = (1 << TOIE1) | (1 << OCIE1A);
+}
+#endif // TIMER_TICKLESS
+
+/// Request the present tick.  Call with interrupts disabled.
+/**
+	\return the tick that new timeOuts are measured from.
+*/
+inline timerTime_t Timer::Now () const
+{
+#if TIMER_TICKLESS
+	return HardwareTime ();		// _presentTime only advances when an interrupt is taken.
+#elif TIMER_AUTOSCALE
+	// An interrupt is several ticks; count those begun since it.
+	return _presentTime + _lead + ((((uint32_t) _stamp () << prescalerShift [_prescaler]) + _residue) >> 8);
+#else
+	return _presentTime;
+#endif
+}
+
+#if TIMER_SLACK
+/// Move the timeOut of a timer with slack to the tick it will share with others.
+/// The window runs from the timeOut the timer would have without slack to slack
+/// ticks later.  The earliest queued timer due within the window sets the tick;
+/// with none, the tick is the one in the window that is the largest multiple of
+/// a power of two.  The move is remembered in _offset so that the next period
+/// counts from where the timer was due.  Call with interrupts disabled.
+/**
+	\param pTE points to a timer that is about to be queued.
+*/
+inline void Timer::Align (const p_timeElement pTE)
+{
+	timerTime_t lo = pTE->_timeOut, hi = lo + pTE->_slack, t = hi;
+
+	pTE->_offset = 0;
+	if (0 == pTE->_slack)
+		return;
+	if (!_queue.Find (lo, hi, t))
+		for (timerTime_t unit = 2; unit && !timerBefore (hi & ~(unit - 1), lo); unit <<= 1)
+			t = hi & ~(unit - 1);
+	pTE->_offset = t - lo;
+	pTE->_timeOut = t;
+}
+#endif
+
+/// Insert timer with pointer pArg into the queue at the location that keeps the
+/// queue sorted in increasing timeout time order.  A timer that is already running
+/// is moved.  This function is for internal use only.
+/**
+	\param pArg is a pointer to the timerElement that needs inserted into the queue.
+	\return false if the queue is full and pArg was not inserted.
+*/
+bool Timer::InsertTimer (const p_timeElement pArg)
+{
+	bool queued = true;
+
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		pArg->_owner = this;
+#if TIMER_AUTOSCALE
+		Claim (pArg);			// Before Align () moves the timeOut.
+#endif
+#if TIMER_SLACK
+		Align (pArg);
+#endif
+#if TIMER_BOUNDED
+		if (_queue.Contains (pArg))
+			_queue.Update (pArg);	// Restarting a running timer moves it.
+		else
+			queued = _queue.Insert (pArg);
+#else
+		_queue.Remove (pArg);	// Restarting a running timer moves it.
+		_queue.Insert (pArg);
+#endif
+#if TIMER_AUTOSCALE
+		if (!queued)
+			Release (pArg);
+#endif
+#if TIMER_STATS
+		if (_queue.GetCount () > _stats.maxDepth)
+			_stats.maxDepth = _queue.GetCount ();
+#endif
+#if TIMER_TRACE
+		if (queued)
+			Trace (TIMER_TRACE_START, pArg, 0, _stamp ());
+#endif
+	}
+	return queued;
+}
+
+/// Insert a group of timers whose timeOuts are set.  The sorted list sets them all
+/// aside and merges them in one pass, O(k log k + n) for k timers rather than
+/// O(k * n); the other engines insert them one at a time, which costs them no more
+/// than O(log n) each.  Timers already running are moved.  For internal use only.
+/**
+	\param te points to n timeElements.
+	\param n is the number of timers.
+	\return the number of timers queued; fewer than n only if the queue filled.
+*/
+uint8_t Timer::InsertTimers (const p_timeElement te, const uint8_t n)
+{
+	uint8_t queued = 0;
+
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+#if TIMER_ENGINE == TIMER_ENGINE_LIST
+		for ( ; queued < n; queued++)
+		{
+			p_timeElement pTE = &te [queued];
+
+			pTE->_owner = this;
+	#if TIMER_AUTOSCALE
+			Claim (pTE);
+	#endif
+	#if TIMER_SLACK
+			Align (pTE);
+	#endif
+			_queue.Remove (pTE);	// Restarting a running timer moves it.
+			_queue.Hold (pTE);
+	#if TIMER_TRACE
+			Trace (TIMER_TRACE_START, pTE, 0, _stamp ());
+	#endif
+		}
+		_queue.Merge (_presentTime);
+	#if TIMER_STATS
+		if (_queue.GetCount () > _stats.maxDepth)
+			_stats.maxDepth = _queue.GetCount ();
+	#endif
+#else
+		for (uint8_t i=0; i<n; i++)
+			if (InsertTimer (&te [i]))
+				queued++;
+#endif
+	}
+	return queued;
+}
+
+#if TIMER_ENGINE == TIMER_ENGINE_LIST
+/// Request the timeout time for an indexed timer by walking the queue from its head.
+/**
+	\param i is the index of the relevant timer in timeOut order.
+	\return the value of presentTime needed for the timer to expire, or 0 if fewer
+			  than i + 1 timers are running.
+*/
+timerTime_t Timer::getTimeOut (uint16_t i)
+{
+	timerTime_t to = 0;
+
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		p_timeElement pTE = _queue.Head ();
+
+		for ( ; pTE && i > 0; i--)
+			pTE = pTE->_next;
+		if (pTE)
+			to = pTE->getTimeOut ();
+	}
+	return to;
+}
+#endif // TIMER_ENGINE_LIST
+
+#if TIMER_STATS
+/// Copy the measurements of the ISR with interrupts disabled, so that the fields
+/// agree with one another.
+/**
+	\param s receives the measurements.
+*/
+void Timer::getStats (timerStats_t &s) const
+{
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		s = _stats;
+	s.countsPerTick = CountsPerTick ();
+}
+
+/// Forget the measurements of the ISR.  The measurements of each timer are reset
+/// by timeElement.resetStats ().
+void Timer::resetStats ()
+{
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		_stats.Reset ();
+}
+#endif // TIMER_STATS
+
+
+/// Request the stamp at which a tick began.  Ticked counters start each tick
+/// from 0, so an earlier tick began a multiple of 256 counts before; the tickless
+/// counter runs on, 1 << _tickShift counts a tick.  Under TIMER_AUTOSCALE the 256
+/// counts between interrupts span as many ticks as the prescaler division.
+/**
+	\param tick is _presentTime or an earlier tick.
+	\return the stamp of the tick, modulo 0x10000.
+*/
+inline uint16_t Timer::TickStamp (const timerTime_t tick) const
+{
+#if TIMER_TICKLESS
+	return tick << _tickShift;
+#elif TIMER_AUTOSCALE
+	return ((int32_t) (tick - _presentTime) << 8) >> prescalerShift [_prescaler];
+#else
+	return (tick - _presentTime) << 8;
+#endif
+}
 
-	SREG = __sreg;			// Restore the processor's status register and interrupt mask.
+/// Request the length of a tick in counts of the hardware counter.  Under
+/// TIMER_AUTOSCALE it is the length of an interrupt, which is several ticks.
+/**
+	\return counts per tick.
+*/
+inline uint16_t Timer::CountsPerTick () const
+{
+#if TIMER_TICKLESS
+	return 1 << _tickShift;
+#else
+	return 256;
+#endif
+}
 
-	// Return the index of the first List element needing moved.
-	return (i);
+/// Request the CPU cycles from one interrupt of the clock to the next; when
+/// tickless, the length of a tick.
+/**
+	\return CPU cycles per interrupt.
+*/
+inline uint32_t Timer::TickCycles () const
+{
+#if TIMER_AUTOSCALE
+	return 256UL << prescalerShift [_prescaler];
+#else
+	return (uint32_t) CountsPerTick () << _countShift;
+#endif
 }
+
+#if TIMER_AUTOSCALE
+/// Count a timer that is being queued under the coarsest prescaler whose interrupts
+/// land on all its timeOuts, and switch to that prescaler at once if the present one
+/// is coarser.  A timer already counted is counted again, since its period or
+/// timeOut may have changed; Fire () counts each timer again as it queues it for
+/// its next expiration.  Call with interrupts disabled.
+/**
+	\param pTE points to the timer, with its period and timeOut set.
+*/
+inline void Timer::Claim (const p_timeElement pTE)
+{
+	Release (pTE);
+	pTE->_scale = pTE->_timePeriod ? ScaleOf (pTE->_timePeriod | pTE->_timeOut) : 1;	// Period 0 fires each tick.
+	_running [pTE->_scale - 1]++;
+	if (pTE->_scale < _target)
+		_target = pTE->_scale;
+	if (_target < _prescaler)
+		Prescale (_target);
+}
+
+/// Stop counting a timer that has stopped.  The prescaler is made coarser by the
+/// next interrupt, should this allow it.  Timers not counted are ignored.  Call with
+/// interrupts disabled.
+/**
+	\param pTE points to the timer.
+*/
+inline void Timer::Release (const p_timeElement pTE)
+{
+	if (0 == pTE->_scale)
+		return;
+	if (0 == --_running [pTE->_scale - 1] && pTE->_scale == _target)
+		for (_target = 1; _target < 7 && 0 == _running [_target - 1]; _target++)
+			;
+	pTE->_scale = 0;
+}
+
+/// Move to the coarsest prescaler the running timers allow whose interrupts land on
+/// the present tick, as every later one of them then does.  Called by NextTick ()
+/// only, once the due timers have been called back.
+inline void Timer::Rescale ()
+{
+	uint8_t code = _target;
+
+	while (code > _prescaler && (_presentTime & (((timerTime_t) 1 << prescalerShift [code]) - 1)))
+		code--;
+	if (code > _prescaler)
+		Prescale (code);
+}
+
+/// Switch Timer/Counter 2 to another prescaler without disturbing the clock.  The
+/// ticks that have passed since the present interrupt began are taken into _lead,
+/// as far as the last tick on which the new prescaler would interrupt, and the
+/// counter is set to the counts of the new prescaler since that tick.  A pending
+/// overflow is counted in them too.  The part of a count that the counter cannot
+/// show is kept in _residue and added at the next switch.  Going finer, the switch
+/// waits for the next count of the present division, at most 1024 cycles, since
+/// the cycles that passed toward it cannot be read.  So the clock does not drift
+/// however often the prescaler changes.  Call with interrupts disabled; when going
+/// coarser, from the interrupt of a tick the new prescaler shares.
+/**
+	\param code is the new prescaler code, 1 to 7.
+*/
+void Timer::Prescale (const uint8_t code)
+{
+	uint8_t shift = prescalerShift [code];
+
+	if (code < _prescaler)
+		for (uint8_t count = TCNT2; count == TCNT2; )
+			_NOP ();		// Start at the edge of a count, none of whose cycles then passed.
+
+	uint32_t cycles = ((uint32_t) _stamp () << prescalerShift [_prescaler]) + _residue;
+	timerTime_t ticks = (cycles >> 8) & ~(((timerTime_t) 1 << shift) - 1);
+	uint32_t rest = cycles - (ticks << 8);
+
+	TCCR2B = code;
+	GTCCR = 1 << PSRASY;		// Start the new division from this cycle.
+	TCNT2 = rest >> shift;
+	TIFR2 = 1 << TOV2;		// A pending overflow is in ticks.
+	_residue = rest & (((uint16_t) 1 << shift) - 1);
+	_lead += ticks;
+	_prescaler = code;
+}
+#endif // TIMER_AUTOSCALE
+
+#if TIMER_TRACE
+/// Record an event, stamped with the present tick and the counts since it began.
+/// Called with interrupts disabled.
+/**
+	\param kind is a timerTraceKind_t.
+	\param pTE points to the timer concerned, or is 0.
+	\param data depends on kind; see timerTraceKind_t.
+	\param stamp is the hardware counter, read by the caller.
+*/
+inline void Timer::Trace (const uint8_t kind, const p_timeElement pTE, const uint8_t data, const uint16_t stamp)
+{
+	timerTraceEvent_t e;
+
+	e.timer = (uint16_t) (uintptr_t) pTE;
+	e.tick = _presentTime;
+	e.counts = stamp - TickStamp (_presentTime);
+	e.kind = kind;
+	e.data = data;
+	_trace.Record (e);
+}
+
+/// Start a dump:  encode its header and fix the number of records it holds.  The
+/// records are held until TraceRecord () takes them, so events recorded while the
+/// dump is written cannot overwrite them; should the recorder fill meanwhile, the
+/// new events are dropped and counted in the next dump's header.
+/**
+	\param header receives the 10 bytes of the header.
+	\return the number of records that follow.
+*/
+uint16_t Timer::TraceHeader (uint8_t header [10])
+{
+	uint16_t dropped, n;
+
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		dropped = _trace.TakeDropped ();
+		n = _trace.Hold ();
+	}
+
+	uint16_t cpt = CountsPerTick ();
+
+	header [0] = 'T';
+	header [1] = 'T';
+	header [2] = TIMER_TRACE_VERSION;
+	header [3] = sizeof (timerTraceEvent_t);
+	header [4] = cpt;
+	header [5] = cpt >> 8;
+	header [6] = dropped;
+	header [7] = dropped >> 8;
+	header [8] = n;
+	header [9] = n >> 8;
+	return n;
+}
+
+/// Take the oldest record and encode it little-endian.  The dump holds the
+/// records counted by TraceHeader (), and only dumps take records, so there is
+/// always one; were there none, a record of kind 0 would be encoded instead.
+/**
+	\param record receives the 8 bytes of the record.
+*/
+void Timer::TraceRecord (uint8_t record [8])
+{
+	timerTraceEvent_t e = {0, 0, 0, 0, 0};
+
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		_trace.Pop (e);
+	record [0] = e.timer;
+	record [1] = e.timer >> 8;
+	record [2] = e.tick;
+	record [3] = e.tick >> 8;
+	record [4] = e.counts;
+	record [5] = e.counts >> 8;
+	record [6] = e.kind;
+	record [7] = e.data;
+}
+#endif // TIMER_TRACE
+
+#if !TIMER_TICKLESS && !TIMER_AUTOSCALE
+// The ISRs of TimerT, compiled for each counter it can run on.  The linker keeps
+// only those a sketch binds with TIMER_ISR.
+template void Timer::NextTick<TimerHw<0> > ();
+template void Timer::NextTick<TimerHw<1> > ();
+template void Timer::NextTick<TimerHw<2> > ();
+#endif
@@ -18,6 +18,8 @@
 ///											F_CPU
 ///
 ///				where p is the prescaler and x is the timeElement.setPeriod (x) value.
+///				Times and periods are 32-bit timerTime_t tick counts, so x may be up to
+///				0x7FFFFFFF; the clock itself rolls over only after 2^32 ticks.
 ///         2  Instantiate an object of type timeElement.
 ///         3  Populate the object with the timer period, number of times to repeat
 ///            the alarm (0=infinite), a pointer (timerCallBack_t) to a function, and a
@@ -25,52 +27,473 @@
 ///            pointer will be delivered as the sole argument to the call-back function
 ///            each time the timer expires.
 ///         4  Call the 'startTimer' function with the pointer to this populated
-///            timeElement object's pointer as its argument.
+///            timeElement object's pointer as its argument.  'startTimer' returns
+///            false only when the heap engine (see 8) is full.
 ///         5  Call the 'cancelTimer' function in the event that the timer should be
 ///            terminated.  The argument for 'cancelTimer' should be the pointer to
 ///            the same timeElement object that was sent to 'startTimer'.
-///         6  Up to 'MAX_LIST_PTRS' timers can be executing simultaneously.
-///            'MAX_LIST_PTRS' is defined to be 5 in List.h if the user does not define
-///				 it first.  The default value (5) can be changed at the user's
-///            discretion; RAM can be freed by its reduction or more timers can be
-///            available by its increase.
+///         6  Any number of timers can be executing simultaneously.  Each
+///            timeElement carries the links that queue it, so the running timers
+///            cost no RAM beyond the timeElements the caller already owns.  A
+///            timeElement must stay in scope while its timer is running.
 ///			7	While a timer is running, its parameters can be modified using the
-///				timeElement.modifyXxxx () functions.  Using the timeElement.setXxxx ()
-///				functions while the timer is running can cause abnormal behavior.
+///				timeElement.modifyXxxx () functions; modifyPeriod and modifyTimeOut
+///				move the timer to its new place in the queue.  'rescheduleTimer' moves
+///				a timer's next expiration to a given time.  Using the
+///				timeElement.setXxxx () functions while the timer is running can cause
+///				abnormal behavior.
+///			8	The queue of running timers is chosen at compile time by defining
+///				TIMER_ENGINE before this header is included:
+///					TIMER_ENGINE_LIST		The sorted queue of TimerQueue.h (default).
+///											Starting and re-queuing after an expiration
+///											walk the queue; canceling is O(1).
+///					TIMER_ENGINE_WHEEL	The hierarchical timing wheel of TimerWheel.h.
+///											Starting, canceling and expiring are O(1).
+///					TIMER_ENGINE_HEAP		The binary min-heap of TimerHeap.h.  Starting,
+///											canceling and rescheduling are O(log n); up
+///											to TIMER_HEAP_SIZE timers can run at once.
+///			9	Defining TIMER_TICKLESS as 1 moves the clock to the 16-bit Timer/Counter 1
+///				and interrupts only when a timer is due (compare match A) or the counter
+///				overflows, instead of every 256 counts.  Ticks keep the length given above
+///				and configTimers still takes the Timer/Counter 2 prescaler codes.  The
+///				Arduino core puts Timer/Counter 1 in PWM mode in init (), so call
+///				configTimers from setup ().
+///			10	Defining TIMER_DEFER as 1 lets a timer's callback run outside the ISR.
+///				A timer marked with timeElement.setDeferred (true) is only queued when it
+///				expires, and its callback runs, with interrupts enabled, the next time
+///				loop () calls timer.dispatch ().  Up to TIMER_DEFER_SIZE timers can wait
+///				for dispatch at once; should the queue be full, the callback runs in the
+///				ISR as usual so that no expiration is lost.
+///			11	TimerT.h offers TimerT<Capacity, HwTimer, Prescaler>, a Timer whose hardware
+///				timer, prescaler and heap capacity are fixed at compile time, with
+///				constexpr conversions from microseconds and milliseconds to ticks.
+///				Each TimerT runs on its own Timer/Counter (0, 1 or 2) with its own
+///				queue, so several schedulers can run at different tick rates.  A
+///				timeElement belongs to the Timer that started it until it stops.
+///			12	A timer is due when presentTime reaches or passes its timeOut, so a late
+///				timer fires at the next opportunity instead of after the clock rolls
+///				over.  What a periodic timer does about further deadlines that passed
+///				meanwhile is chosen with timeElement.setOverrun ():  fire once for each
+///				(TIMER_CATCHUP, the default), fire once and restart its period from
+///				now (TIMER_RESYNC), or fire once and skip to its next deadline on the
+///				original schedule (TIMER_SKIP).  A repeating timer with a period of 0
+///				fires once each tick.  When tickless, the clock is read from the
+///				hardware counter, so every count that passed while interrupts were
+///				disabled is accounted for.  The ticked clock counts interrupts.  The
+///				ISR takes an overflow pending after each callback and counts it at
+///				once, so long callbacks lose no ticks, but an 8-bit counter cannot
+///				tell how many overflows coalesced while a sketch kept interrupts
+///				disabled for two ticks or more.
+///			13	Defining TIMER_SLACK as 1 lets a timer fire up to timeElement.setSlack (s)
+///				ticks after its timeOut.  When such a timer is queued, it joins the
+///				earliest timer already due within its window, or else takes the tick
+///				of the window that is the largest multiple of a power of two, where
+///				other timers are most likely to join it.  Timers that fire together
+///				cost one expiry pass (one interrupt when tickless) instead of several.
+///				The slack is not added to the schedule:  each period is still counted
+///				from the previous timeOut the timer would have had without slack.
+///			14	Defining TIMER_STATS as 1 measures every timer's callbacks and lateness
+///				and each Timer's ISR load; read them from loop () with getStats ().
+///				See TimerStats.h.
+///			15	A loop () that only waits for timers can sleep instead:
+///
+///					void loop () {timer.idleUntilNextTimer ();}
+///
+///				sleeps, in the deepest mode that keeps the Timer's counter running,
+///				until the next timer has been called back.  That is idle mode, or
+///				power-save when Timer/Counter 2 runs from a watch crystal; power-save
+///				also stops Timer/Counter 0 and so millis ().  Ticked, the processor
+///				still wakes for each tick's interrupt; tickless, only for due timers
+///				and the counter's overflow.  Other interrupts are served as they come.
+///				ticksUntilNextTimer () tells how long the wait would be.
+///			16	Besides a timerCallBack_t and its argument, setCallBack () binds a member
+///				function to its object, or a lambda, without a trampoline of your own:
+///
+///					te.setCallBack<LED, &LED::blinkMe> (&led);
+///					te.setCallBack ([&led] {led.blinkMe ();});
+///
+///				A lambda is copied into the timeElement, so its captures must be
+///				trivially copyable.  One that captures no more than a pointer is kept
+///				in place of the argument and costs nothing.  A larger one needs
+///				TIMER_CAPTURE_SIZE defined as its size, which reserves that many bytes
+///				in every timeElement; without it, it does not compile.  Either way the
+///				ISR makes a single indirect call.
+///				modifyCallBack () takes the same arguments and replaces the function
+///				and its argument together, atomically.
+///			17	TimerPool.h offers TimerPool<Slots>, a fixed slab of timeElements that
+///				starts timers from a parameter struct and hands back {index,
+///				generation} handles.  Canceling or modifying by handle is O(1), and a
+///				stale handle is refused instead of reaching a reused slot.
+///			18	TimerFlash.h offers TimerFlash<N>, a fixed schedule of N timers written as
+///				a table in flash:
+///
+///					const timerSchedule_t blinks [3] PROGMEM = {
+///						{0xF400, 0, callBack, &led [0], 0},
+///						{0x7A00, 0, callBack, &led [1], 0},
+///						{0x5100, 0, callBack, &led [2], 0x2000}};
+///					TimerFlash<3> blinkers (timer, blinks);
+///
+///					blinkers.start ();
+///
+///				Each entry gives the period, repeats, callback, argument and a phase
+///				that delays the first expiration only.  Only the deadlines and the
+///				repeats left are kept in SRAM, 6 bytes an entry, and the schedule
+///				takes one place in the queue however many entries it has.
+///			19	'startTimers' starts a group of timeElements from one tick, each
+///				optionally delayed by its own phase, in one critical section:
+///
+///					const timerTime_t phase [3] = {0, 0x1000, 0x2000};
+///
+///					timer.startTimers (timerData, phase);
+///
+///				The members stay phase-locked even if a tick falls during the call.
+///				The list engine sorts the group and merges it into the queue in one
+///				pass.  'cancelTimers' stops a group in one critical section.
+///			20	Defining TIMER_STAGE as 1 lets loop () retune running timers without
+///				disabling interrupts.  Describe the changes and stage them:
+///
+///					timer.stageUpdate (timerUpdate_t (&te).setPeriod (500).setRepeats (3));
+///
+///				The ISR applies every field at once at its next tick (when tickless,
+///				its next interrupt), moving the timer to its new place in the queue
+///				as modifyPeriod () and modifyTimeOut () would.  Up to TIMER_STAGE_SIZE
+///				updates can wait; stageUpdate () returns false when they are full.
+///				Stage from loop () only.  A callback already runs with interrupts
+///				disabled and should call the modifyXxxx () functions.
+///			21	Defining TIMER_TRACE as 1 records starts, cancels, callbacks and lost
+///				ticks, stamped to the count of the hardware counter, in a ring of
+///				TIMER_TRACE_SIZE events.  timer.dumpTrace (Serial) writes them out in
+///				binary; extras/trace decodes a capture into timelines and per-timer
+///				latency and jitter.  See TimerTrace.h.
+///			22	timer.now () reads the clock to a single count of the hardware counter,
+///				and timer.millis (), timer.micros () and timer.delay () stand in for the
+///				Arduino core's, wrapping at 2^32 milliseconds and microseconds as
+///				they do.  timer.elapsed (mark, ms) is a delay that does not block:
+///
+///					if (timer.elapsed (last, 250))
+///						blink ();		// Every 250 ms.
+///
+///				A sketch that uses these in place of the core's can turn off the
+///				core's Timer/Counter 0 overflow interrupt (TIMSK0 &= ~(1 << TOIE0))
+///				and save its load.  Exact for F_CPU a multiple of 1 MHz.  Ticked, the
+///				clock counts overflows:  interrupts kept disabled for longer than a
+///				tick (16 us at 16 MHz at the default prescaler) can lose ticks, and
+///				millis () and micros () then fall behind (see note 12).  Use
+///				TIMER_TICKLESS, or a coarser prescaler, if a sketch needs such windows.
+///			23	Defining TIMER_AUTOSCALE as 1 lets the Timer choose the prescaler.  A tick
+///				is then always 256 CPU cycles, the tick of prescaler 1 (16 us at 16 MHz),
+///				and each interrupt advances the clock by the prescaler division.  The
+///				Timer runs Timer/Counter 2 at the coarsest division that divides the
+///				period and timeOut of every running timer, so that each still expires
+///				on its exact tick.  It moves to a finer division as soon as a timer
+///				needs one and back to a coarser one, at a tick the coarser division
+///				shares, once no running timer needs the finer.  With no timers
+///				running it interrupts every 1024 ticks.  A timer's first period counts
+///				from the present tick, so its timeOuts share only the divisions that
+///				divide that tick as well:  the periods 0xF400, 0x7A00 and 0x5100 of
+///				Blink_3i need an interrupt only every 256 ticks if they start on a
+///				multiple of 256, as rescheduleTimer () can arrange.  The clock
+///				keeps the part of a count that a change of division hides from the
+///				counter, so it does not drift; a move to a finer division waits for
+///				the next count of the coarser, up to 64 us at 16 MHz.  configTimers
+///				is not available; now () counts CPU cycles.  TimerT and
+///				TIMER_TICKLESS have fixed prescalers and TIMER_TRACE stamps events with
+///				the counter, so none of them can be combined with TIMER_AUTOSCALE.
+///			24	TimerScheduler.h turns timers into cooperative tasks.  A timerTask's
+///				timer only releases it, in constant time; TimerScheduler.run (), called
+///				from loop (), runs the released jobs to completion, by earliest deadline
+///				(TIMER_EDF) or by fixed priority (TIMER_PRIORITY), with interrupts
+///				enabled.  Serial output and other slow work then stay out of the ISR.
+///				Each task counts its runs, its missed deadlines and its worst response.
+///			25	TimerCoroutine.h writes a sequence of steps and waits as one routine:
+///
+///					TIMER_AWAIT (timer.sleep (20));		// A TimerThread, any compiler.
+///					co_await timer.sleep (20);			// A TimerCoroutine, C++20.
+///
+///				The expiry of the wait resumes the routine where it left off, in the
+///				timer's callback.  Neither kind has a stack of its own; a TimerThread
+///				costs a timeElement and a few bytes, so dozens can run at once.
+///			26	On the AVR a timeElement takes 21 bytes of SRAM with the list or wheel
+///				engine, and 19 with the heap, which also reserves a 2-byte slot in the
+///				Timer for each timer it can hold.  Each option that keeps something per
+///				timer adds to every timeElement:
+///
+///					TIMER_CAPTURE_SIZE		its value, rounded up to even
+///					TIMER_DEFER				2
+///					TIMER_SLACK				4
+///					TIMER_AUTOSCALE			1
+///					TIMER_STATS				14
+///
+///				extras/bench/TimerBench.cpp prints the size on the host, where the
+///				pointers are wider.
 //////////////////////////////////////////////////////////////////////////////////////
 
 #ifndef TIMER_H
 #define TIMER_H
 
-#include "List.h"
-
 #include <inttypes.h>
-#include <avr/io.h>
-#include <util/atomic.h>
+#include <string.h>
+#include "TimerHal.h"
+
+#define TIMER_ENGINE_LIST	0		///< Sorted queue of timeElements.
+#define TIMER_ENGINE_WHEEL	1		///< Hierarchical timing wheel.
+#define TIMER_ENGINE_HEAP	2		///< Binary min-heap.
+
+#ifndef TIMER_ENGINE
+	#define TIMER_ENGINE TIMER_ENGINE_LIST
+#endif
+
+/// The heap holds the running timers in an array of fixed capacity.
+#define TIMER_BOUNDED (TIMER_ENGINE == TIMER_ENGINE_HEAP)
+
+#ifndef TIMER_TICKLESS
+	#define TIMER_TICKLESS 0		///< 1 = interrupt only when a timer is due.
+#endif
+
+/// Tick count of the interrupt clock.  Times roll over from 0xFFFFFFFF to 0, so
+/// two times are ordered by the sign of their difference (timerBefore) and any
+/// timeout within 0x7FFFFFFF ticks of the present time compares correctly.
+typedef uint32_t timerTime_t;
+
+/// Asks whether time a comes before time b.
+/**
+	\param a is one time.
+	\param b is the other time.
+	\return true if a is earlier than b, allowing for roll over.
+*/
+inline bool timerBefore (const timerTime_t a, const timerTime_t b) {return (int32_t) (a - b) < 0;}
+
+/// Compute the base-two logarithm of a prescaler division.
+/**
+	\param p is a power of two.
+	\return log2 (p).
+*/
+constexpr uint8_t timerLog2 (const uint16_t p)
+{
+	return p > 1 ? 1 + timerLog2 (p >> 1) : 0;
+}
+
+/// Convert microseconds to the nearest whole number of ticks, T = 256 * p * x / F_CPU
+/// solved for x.  Being constexpr, a constant argument costs no division at run time.
+/**
+	\param us is the interval in microseconds.
+	\param p is the prescaler division, not the CS code.
+	\return the number of ticks, which may be 0 for very short intervals.
+*/
+constexpr uint64_t timerUsToTicks (const uint32_t us, const uint16_t p)
+{
+	return ((uint64_t) us * (F_CPU / 1000) + 128000ULL * p) / (256000ULL * p);
+}
+
+/// Convert milliseconds to the nearest whole number of ticks.
+/**
+	\param ms is the interval in milliseconds.
+	\param p is the prescaler division, not the CS code.
+	\return the number of ticks, which may be 0 for very short intervals.
+*/
+constexpr uint64_t timerMsToTicks (const uint32_t ms, const uint16_t p)
+{
+	return ((uint64_t) ms * F_CPU + 128000ULL * p) / (256000ULL * p);
+}
+
+#ifndef TIMER_DEFER
+	#define TIMER_DEFER 0			///< 1 = timers may defer their callbacks to dispatch ().
+#endif
+
+#ifndef TIMER_DEFER_SIZE
+	#define TIMER_DEFER_SIZE 8		///< Timers that can await dispatch (); a power of two.
+#endif
+
+#ifndef TIMER_STAGE
+	#define TIMER_STAGE 0			///< 1 = loop () may stage timer updates for the ISR.
+#endif
+
+#ifndef TIMER_STAGE_SIZE
+	#define TIMER_STAGE_SIZE 8		///< Updates that can await the ISR; a power of two.
+#endif
+
+#ifndef TIMER_TRACE
+	#define TIMER_TRACE 0			///< 1 = record timer events for dumpTrace ().
+#endif
+
+#ifndef TIMER_TRACE_SIZE
+	#define TIMER_TRACE_SIZE 32		///< Events the trace holds; a power of two up to 128.
+#endif
+
+#ifndef TIMER_STATS
+	#define TIMER_STATS 0			///< 1 = measure callbacks, lateness and ISR load.
+#endif
+
+#ifndef TIMER_SLACK
+	#define TIMER_SLACK 0			///< 1 = timers may fire late to coalesce with others.
+#endif
+
+#ifndef TIMER_AUTOSCALE
+	#define TIMER_AUTOSCALE 0		///< 1 = the Timer picks the coarsest prescaler its timers allow.
+#endif
+
+#if TIMER_AUTOSCALE && (TIMER_TICKLESS || TIMER_TRACE)
+	#error TIMER_AUTOSCALE cannot be combined with TIMER_TICKLESS or TIMER_TRACE
+#endif
+
+#ifndef TIMER_CAPTURE_SIZE
+	#define TIMER_CAPTURE_SIZE 0	///< Bytes a lambda larger than a pointer may capture.
+#endif
+
+#if TIMER_ENGINE == TIMER_ENGINE_WHEEL
+	#include "TimerWheel.h"
+#elif TIMER_ENGINE == TIMER_ENGINE_HEAP
+	#include "TimerHeap.h"
+#else
+	#include "TimerQueue.h"
+#endif
+
+#if TIMER_DEFER || TIMER_STAGE
+	#include "TimerRing.h"
+#endif
+
+#if TIMER_STATS
+	#include "TimerStats.h"
+#endif
+
+#if TIMER_TRACE
+	#include "TimerTrace.h"
+#endif
 
 typedef void (*timerCallBack_t)(void *);
 
+/// Reads the counter that drives a Timer.  The difference of two readings is the
+/// counts elapsed between them, for up to about one tick (tickless:  65535 counts).
+typedef uint16_t (*timerStamp_t)();
+
+/// What a periodic timer does when it fires so late that its next deadline has
+/// passed too.
+enum timerOverrun_t : uint8_t
+{
+	TIMER_CATCHUP,		///< Fire once for every missed deadline, back to back.
+	TIMER_RESYNC,		///< Fire once; the next deadline is one period from now.
+	TIMER_SKIP			///< Fire once; skip to the next deadline on the original schedule.
+};
+
+class Timer;
+
+/// A wait of some ticks, made by Timer.sleep ().  A TimerThread suspends on it with
+/// TIMER_AWAIT () and a TimerCoroutine with co_await; see TimerCoroutine.h.
+struct timerSleep_t
+{
+	Timer &timer;				///< The Timer that resumes the sleeper.
+	timerTime_t ticks;			///< Ticks from the end of the previous sleep.
+	bool slept;					///< False if the Timer had no room to wait.
+
+	/// Never ready at once; even 0 ticks waits for the next tick.
+	bool await_ready () const {return false;}
+
+	/// Ask the coroutine's promise to wake it when the ticks have passed.
+	/**
+		\param h is the handle of the coroutine being suspended.
+		\return false, to go on at once, if the Timer had no room.
+	*/
+	template <class H>
+	bool await_suspend (H h)
+	{
+		slept = true;		// Before Sleep (); the ISR may resume the coroutine from then on.
+		if (h.promise ().Sleep (*this))
+			return true;
+		slept = false;
+		return false;
+	}
+
+	/// The value of co_await.
+	/**
+		\return false if the coroutine did not sleep because the Timer was full.
+	*/
+	bool await_resume () const {return slept;}
+};
+
+#if TIMER_STAGE
+/// Changes to a timer, staged by Timer.stageUpdate () and applied together by the
+/// ISR.  Each setXxxx () marks its field; unmarked fields are left alone.
+struct timerUpdate_t
+{
+	/// Start an update of a timer that changes nothing yet.
+	/**
+		\param pTE points to the timer to be changed.
+	*/
+	explicit timerUpdate_t (class timeElement *pTE) : timer (pTE), fields (0) {}
+
+	/// An update of no timer, for storage.
+	timerUpdate_t () : timer (0), fields (0) {}
+
+	/// Replace the period, as timeElement.modifyPeriod () does.
+	timerUpdate_t &setPeriod (const timerTime_t p) {period = p; fields |= PERIOD; return *this;}
+
+	/// Replace the number of repetitions left.
+	timerUpdate_t &setRepeats (const uint16_t r) {repeats = r; fields |= REPEATS; return *this;}
+
+	/// Replace the callback and its argument.
+	timerUpdate_t &setCallBack (const timerCallBack_t cb, void *a) {callBack = cb; arg = a; fields |= CALLBACK; return *this;}
+
+	/// Replace the next expiration, as timeElement.modifyTimeOut () does.
+	timerUpdate_t &setTimeOut (const timerTime_t to) {timeOut = to; fields |= TIMEOUT; return *this;}
+
+	enum {PERIOD = 1, REPEATS = 2, CALLBACK = 4, TIMEOUT = 8};	///< Bits of fields.
+
+	class timeElement *timer;	///< The timer to be changed.
+	uint8_t fields;				///< The fields set, as PERIOD | REPEATS | ...
+	timerTime_t period;			///< The new period.
+	timerTime_t timeOut;		///< The new timeOut; applied after the period.
+	uint16_t repeats;			///< The new repetitions left.
+	timerCallBack_t callBack;	///< The new callback.
+	void *arg;					///< The new argument of callBack.
+};
+#endif
+
 /// timeElement stores all the information needed for the smooth functioning of the
 /// interrupt driven timer class.
 ///
 class timeElement
 {
+friend class TimerWheel;	///< The wheel threads its slot lists through the timeElements.
+friend class TimerQueue;	///< So does the sorted queue.
+friend class TimerHeap;		///< The heap records each timer's position.
+friend class Timer;			///< Timer queues the timeElements and counts deferred expirations.
+
 public:
 /// Constructs a timeElement object to hold everything needed to operate a timer.
 /**
-	\param p is the timer's timeout period and defaults to 0x7FFF.
+	\param p is the timer's timeout period and defaults to 0x7FFF ticks.
 	\param r is the number of times the timer will time out before self canceling;
 			 r defaults to 0 (infinite and never stops).
 */
-	timeElement (uint16_t p=0x7fff, uint16_t r=0)
-		: _timePeriod (p), _repeats (r) {}
+	timeElement (timerTime_t p=0x7fff, uint16_t r=0)
+		: _timePeriod (p), _repeats (r)
+#if TIMER_ENGINE == TIMER_ENGINE_HEAP
+		, _heapIndex (0)
+#else
+		, _next (0), _pprev (0)
+#endif
+		, _owner (0), _overrun (TIMER_CATCHUP)
+#if TIMER_DEFER
+		, _deferred (false), _pending (0)
+#endif
+#if TIMER_SLACK
+		, _slack (0), _offset (0)
+#endif
+#if TIMER_AUTOSCALE
+		, _scale (0)
+#endif
+		{
+#if TIMER_STATS
+			_stats.Reset ();
+#endif
+		}
 
 	/// Set the timeout period for the timer.  Do NOT use this function if the timer
 	/// has already been started (startTimer); use modifyPeriod () instead.
 	/**
 		\param p is the timer's new timeout period.
 	*/
-	void setPeriod (uint16_t p) {_timePeriod = p;}
+	void setPeriod (timerTime_t p) {_timePeriod = p;}
 
 	/// Set the number of times the timer will time out before self canceling.
 	/**
@@ -85,12 +508,93 @@ public:
 	*/
 	void setCallBack (timerCallBack_t cb) {_callBack = cb;}
 
+	/// Set the function to be called each time the timer expires and its argument.
+	/**
+		\param cb is a pointer to the function called in the ISR.
+		\param a is the (void *) pointer passed to cb.
+	*/
+	void setCallBack (timerCallBack_t cb, void *a) {_callBack = cb; _arg = a;}
+
+	/// Call a member function of an object each time the timer expires:
+	/// te.setCallBack<LED, &LED::blinkMe> (&led).
+	/**
+		\param obj points to the object whose member function M is called.
+	*/
+	template <class C, void (C::*M) ()>
+	void setCallBack (C *obj) {setCallBack (CallMember<C, M>, obj);}
+
+	/// Call a function object, usually a lambda, each time the timer expires.  A
+	/// copy is kept in the timeElement:  in the argument if it fits in a pointer.
+	/**
+		\param f is called with no arguments; it must be trivially copyable, and
+				 no larger than a pointer unless TIMER_CAPTURE_SIZE makes room.
+	*/
+	template <typename F>
+	auto setCallBack (const F &f) -> decltype (f (), void ())
+	{
+		static_assert (sizeof (F) <= sizeof (void *) || sizeof (F) <= TIMER_CAPTURE_SIZE, "the callback captures more than a pointer; define TIMER_CAPTURE_SIZE");
+		static_assert (__is_trivially_copyable (F), "the callback's captures must be trivially copyable");
+		static_assert (alignof (F) <= alignof (void *), "the callback's captures are over-aligned");
+		Capture (f, Fits<sizeof (F) <= sizeof (void *)> ());
+	}
+
 	/// Set the argument passed to CallBack function.
 	/**
 		\param a is a (void *) pointer to the data passed to CallBack.
 	*/
 	void setArg (void *a) {_arg = a;}
 
+#if TIMER_DEFER
+	/// Choose where the CallBack function runs.  Being a single byte, the choice
+	/// can be changed while the timer is running; expirations already queued are
+	/// still dispatched.
+	/**
+		\param d is true to run CallBack from timer.dispatch () or false to run it
+				 in the ISR.
+		\sa Timer.dispatch
+	*/
+	void setDeferred (bool d) {_deferred = d;}
+
+	/// Asks whether the CallBack function runs from timer.dispatch ().
+	/**
+		\return true if deferred or false if called in the ISR.
+	*/
+	bool isDeferred () const {return _deferred;}
+#endif
+
+	/// Choose what the timer does when it fires so late that its next deadline
+	/// has passed too.  Being a single byte, the choice can be changed while the
+	/// timer is running.
+	/**
+		\param o is TIMER_CATCHUP (default), TIMER_RESYNC or TIMER_SKIP.
+	*/
+	void setOverrun (timerOverrun_t o) {_overrun = o;}
+
+	/// Request what the timer does about missed deadlines.
+	/**
+		\return the overrun policy.
+	*/
+	timerOverrun_t getOverrun () const {return _overrun;}
+
+#if TIMER_SLACK
+	/// Allow the timer to fire late so that it can fire together with others.
+	/// Takes effect the next time the timer is queued.
+	/**
+		\param s is the most ticks the timer may fire after its timeOut.
+	*/
+	void setSlack (uint16_t s)
+	{
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+			_slack = s;
+	}
+
+	/// Request how late the timer may fire.
+	/**
+		\return the slack in ticks.
+	*/
+	uint16_t getSlack () const {return _slack;}
+#endif
+
 	/// Set the presentTime needed for the timer to expire.  Ordinarily,
 	/// users will not need this function and timer.getPresentTime ()
 	/// will also be needed to use it effectively.
@@ -98,17 +602,14 @@ public:
 		\param to is the value presentTime will need to be to trigger the timer.
 		\sa getPresentTime, updateTimeOut
 	*/
-	void setTimeOut (uint16_t to) {_timeOut = to & 0x7FFF;}
+	void setTimeOut (timerTime_t to) {_timeOut = to;}
 
-	/// Replace the timer's timeout period.
+	/// Replace the timer's timeout period.  A running timer's next expiration
+	/// moves with it, to the new period after the previous expiration (or start).
 	/**
 		\param p is the new value of the timeout period.
 	*/
-	void modifyPeriod (uint16_t p)
-	{
-		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
-			_timePeriod = p;
-	}
+	void modifyPeriod (timerTime_t p);
 
 	/// Replace the number of times the timer will expire before self canceling.
 	/**
@@ -131,6 +632,39 @@ public:
 			_callBack = cb;
 	}
 
+	/// Replace the CallBack function and its argument in one step.
+	/**
+		\param cb is a pointer to the new CallBack function.
+		\param a is the (void *) pointer passed to cb.
+	*/
+	void modifyCallBack (timerCallBack_t cb, void *a)
+	{
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+			setCallBack (cb, a);
+	}
+
+	/// Replace the CallBack with a member function of an object in one step.
+	/**
+		\param obj points to the object whose member function M is called.
+	*/
+	template <class C, void (C::*M) ()>
+	void modifyCallBack (C *obj)
+	{
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+			setCallBack<C, M> (obj);
+	}
+
+	/// Replace the CallBack with a function object, usually a lambda, in one step.
+	/**
+		\param f is called with no arguments.  See setCallBack ().
+	*/
+	template <typename F>
+	auto modifyCallBack (const F &f) -> decltype (f (), void ())
+	{
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+			setCallBack (f);
+	}
+
 	/// Replace the argument sent to the CallBack function.
 	/***
 		\param a is a pointer to the new CallBack function argument.
@@ -144,28 +678,56 @@ public:
 
 	/// Replace the timeout time for the timer.  Normally the user will not use
 	/// this function and timer.getPresentTime () will be needed to use this
-	/// function effectively.
+	/// function effectively.  A running timer is moved to its new place in the
+	/// queue.
 	/**
 		\param to is the new value of the timeout time for the timer.
-		\sa getPresentTime
+		\sa getPresentTime, Timer.rescheduleTimer
+	*/
+	void modifyTimeOut (timerTime_t to);
+
+#if TIMER_STATS
+	/// Copy the timer's measurements.  Call from loop (), not from a callback.
+	/**
+		\param s receives the measurements.
+		\sa TimerStats.h
 	*/
-	void modifyTimeOut (uint16_t to)
+	void getStats (timeElementStats_t &s) const
 	{
 		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
-			_timeOut = to & 0x7FFF;
+			s = _stats;
 	}
 
+	/// Forget the timer's measurements.
+	void resetStats ()
+	{
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+			_stats.Reset ();
+	}
+#endif
+
+	/// Asks whether the timer is waiting in a Timer's queue.  A timer whose
+	/// callback is executing is not, until the callback returns.
+	/**
+		\return true if the timer is queued.
+	*/
+#if TIMER_ENGINE == TIMER_ENGINE_HEAP
+	bool isRunning () const {return 0 != _heapIndex;}
+#else
+	bool isRunning () const {return 0 != _pprev;}
+#endif
+
 	/// Request the timeout period for the timer.
 	/**
 		\return _timePeriod for the timer.
 	*/
-	uint16_t getTimePeriod () const {return _timePeriod;}
+	timerTime_t getTimePeriod () const {return _timePeriod;}
 
 	/// Request the time when the timer will next expire.
 	/**
 		\return _timeOut is the value of _presentTime when the timer will expire.
 	*/
-	uint16_t getTimeOut () const {return _timeOut;}
+	timerTime_t getTimeOut () const {return _timeOut;}
 
 	/// Request the number of repeats before the timer will self-cancel.
 	/**
@@ -180,7 +742,7 @@ public:
 	/// might result in extra repetetions.  Executing this strategy too early
 	/// for very long period timers may also result in an earlier timeout
 	/// instead of a skipped alarm.
-	int16_t updateTimeOut ();
+	timerTime_t updateTimeOut ();
 
 	/// Execute the CallBack function and send the correct argument.  This
 	/// does not change _repeats and might result in extra alarms being
@@ -196,10 +758,76 @@ public:
 	bool clockAlarm ();
 	timeElement & operator= (timeElement &s);
 protected:
+	bool countRepeat ();	///< Decrement _repeats; false after the last repetition.
+
+	/// The CallBack that setCallBack<C, M> () installs:  M is a constant, so this
+	/// compiles to a direct call of the member function.
+	template <class C, void (C::*M) ()>
+	static void CallMember (void *obj) {(static_cast<C *> (obj)->*M) ();}
+
+	/// Whether a function object fits in the argument pointer.
+	template <bool> struct Fits {};
+
+	/// Keep a function object that fits in place of the argument.
+	template <typename F>
+	void Capture (const F &f, Fits<true>)
+	{
+		void *a = 0;
+
+		memcpy (&a, &f, sizeof (F));
+		setCallBack (CallInPlace<F>, a);
+	}
+
+	/// The CallBack that setCallBack (f) installs when f fits in the argument,
+	/// which holds the copy of f.
+	template <typename F>
+	static void CallInPlace (void *a)
+	{
+		alignas (F) uint8_t f [sizeof (F)];
+
+		memcpy (f, &a, sizeof (F));
+		(*reinterpret_cast<F *> (f)) ();
+	}
+
+#if TIMER_CAPTURE_SIZE
+	/// Keep a function object larger than a pointer in _capture.
+	template <typename F>
+	void Capture (const F &f, Fits<false>)
+	{
+		memcpy (_capture, &f, sizeof (F));
+		setCallBack (CallCapture<F>, _capture);
+	}
+
+	/// The CallBack that setCallBack (f) installs otherwise; its argument points
+	/// to the copy of f.
+	template <typename F>
+	static void CallCapture (void *f) {(*static_cast<F *> (f)) ();}
+#endif
+
+#if !TIMER_BOUNDED
+	/// Link this timer into a list in front of the timer *pprev points to.
+	void linkAt (timeElement **pprev)
+	{
+		_next = *pprev;
+		if (_next)
+			_next->_pprev = &_next;
+		*pprev = this;
+		_pprev = pprev;
+	}
+
+	/// Unlink this timer from whatever list holds it.
+	void unlink ()
+	{
+		*_pprev = _next;
+		if (_next)
+			_next->_pprev = _pprev;
+		_pprev = 0;
+	}
+#endif
 private:
-	uint16_t _timeOut,	///< The future expiration time and is not needed by user.
-	_timePeriod,     		///< The number of ticks between callbacks.
-	_repeats;				///< The number of times the timer should call callBack
+	timerTime_t _timeOut,	///< The future expiration time and is not needed by user.
+	_timePeriod;     		///< The number of ticks between callbacks.
+	uint16_t _repeats;		///< The number of times the timer should call callBack
 								///<   function.  0 means never stop until canceled.
 	timerCallBack_t _callBack;  ///< Set to the callback function address.
 
@@ -209,73 +837,318 @@ private:
 	///<   information can be passed to the callback function by packaging
 	///<   it into a suitable static or global structure and placing its
 	///<   pointer in _arg.
+#if TIMER_CAPTURE_SIZE
+	void *_capture [(TIMER_CAPTURE_SIZE + sizeof (void *) - 1) / sizeof (void *)];	///< A large lambda's copy.
+#endif
+
+#if TIMER_ENGINE == TIMER_ENGINE_HEAP
+	uint16_t _heapIndex;		///< Position in the heap plus one; 0 if not queued.
+#else
+	timeElement *_next;		///< Next timer in the same queue or wheel slot.
+	timeElement **_pprev;	///< The pointer that points to this timer; 0 if not queued.
+#endif
+	Timer *_owner;				///< The Timer that last started this timer.
+	timerOverrun_t _overrun;	///< What to do about missed deadlines.
+#if TIMER_DEFER
+	bool _deferred;			///< Run callBack from Timer::dispatch () instead of the ISR.
+	volatile uint8_t _pending;	///< Expirations awaiting dispatch (); saturates at 255.
+#endif
+#if TIMER_STATS
+	timeElementStats_t _stats;	///< Fires, callback durations and lateness.
+#endif
+#if TIMER_SLACK
+	uint16_t _slack;			///< Most ticks the timer may fire after its timeOut.
+	uint16_t _offset;			///< Ticks _timeOut was moved to coalesce; undone by updateTimeOut ().
+#endif
+#if TIMER_AUTOSCALE
+	uint8_t _scale;			///< The coarsest prescaler code the timer allows; 0 if stopped.
+#endif
 };
 typedef timeElement *p_timeElement;
 
-#define GET_TIMEOUT(x) static_cast<p_timeElement>(_timeOutList[x])->getTimeOut ()
-
 class Timer
 {
-friend inline void Timer2ISR ();   ///< The interrupt service routine needs member access.
+friend inline void Timer1ISR (const bool overflow);	///< The tickless ISRs need member access.
 
 public:
-	/// The constructor initializes the hardware and empties the List.
+	/// The constructor initializes the hardware and empties the queue.
 	Timer();
 
 	/// The destructor disables the interrupt.
 	virtual ~Timer();
 
-	/// Add a timer to the List.
-	void startTimer (const p_timeElement pArg /**< Points to user filled timeElement.*/);
+	/// Add a timer to the queue.
+	bool startTimer (const p_timeElement pArg /**< Points to user filled timeElement.*/);
+
+	/// Start a group of timers from the same tick.
+	uint8_t startTimers (const p_timeElement te, const uint8_t n, const timerTime_t *phase = 0);
+
+	/// Start an array of timers from the same tick.
+	/**
+		\param te is the array of timers.
+		\return the number of timers started.
+	*/
+	template <uint8_t N>
+	uint8_t startTimers (timeElement (&te) [N]) {return startTimers (te, N);}
 
-	/// Remove a timer from the List.
+	/// Start an array of timers from the same tick, each delayed by its phase.
+	/**
+		\param te is the array of timers.
+		\param phase is an array of the same length giving each timer's phase.
+		\return the number of timers started.
+	*/
+	template <uint8_t N>
+	uint8_t startTimers (timeElement (&te) [N], const timerTime_t (&phase) [N])
+	{
+		return startTimers (te, N, phase);
+	}
+
+	/// Move a timer's next expiration, starting it if it is not running.
+	bool rescheduleTimer (const p_timeElement pTE, const timerTime_t timeOut);
+
+#if TIMER_STAGE
+	/// Queue changes to a timer for the ISR to apply at its next tick.
+	bool stageUpdate (const timerUpdate_t &u);
+
+#endif
+	/// Remove a timer from the queue.
 	void cancelTimer (const p_timeElement pTE /**< Same pointer sent to startTimer.*/);
 
+	/// Remove a group of timers from the queue.
+	void cancelTimers (const p_timeElement te, const uint8_t n);
+
+	/// Remove an array of timers from the queue.
+	/**
+		\param te is the array of timers.
+	*/
+	template <uint8_t N>
+	void cancelTimers (timeElement (&te) [N]) {cancelTimers (te, N);}
+
+#if TIMER_AUTOSCALE
+	/// The Timer chooses the prescaler itself.
+	void configTimers (const uint8_t prescaler) = delete;
+#else
 	/// Changes the length of every clock tick.
 	void configTimers (const uint8_t prescaler /**< 0 <= prescaler <= 7*/);
+#endif
+
+	/// Run the callbacks of deferred timers that expired since the last call.
+	uint8_t dispatch ();
+
+	/// Request the ticks from the present time until the next timer is due.
+	timerTime_t ticksUntilNextTimer ();
 
-	/// Make the time sent as argument larger than presentTime.
+	/// Sleep until the next timer is due and has been called back.
+	void idleUntilNextTimer ();
+
+#if TIMER_STATS
+	/// Copy the measurements of the ISR.  Call from loop ().
+	/**
+		\param s receives the measurements.
+		\sa TimerStats.h
+	*/
+	void getStats (timerStats_t &s) const;
+
+	/// Forget the measurements of the ISR.
+	void resetStats ();
+#endif
+
+#if TIMER_TRACE
+	/// Write out and forget the recorded events, oldest first, in the binary
+	/// format of TimerTrace.h.  Recording goes on meanwhile; events recorded after
+	/// the header is written wait for the next dump, and the events the header
+	/// counts are kept for this one.  Call from loop ().
+	/**
+		\param out has a write (const uint8_t *, size_t) member, as Serial does.
+		\return the number of events written.
+	*/
+	template <class Out>
+	uint16_t dumpTrace (Out &out)
+	{
+		uint8_t bytes [10];
+		uint16_t n = TraceHeader (bytes);
+
+		out.write (bytes, 10);
+		for (uint16_t i=0; i<n; i++)
+		{
+			TraceRecord (bytes);
+			out.write (bytes, 8);
+		}
+		return n;
+	}
+#endif
+
+	/// Advance the clock one tick and call back the timers due.  Only the ISR of
+	/// the hardware timer that drives this Timer may call it.  TimerT has its own.
+	void clockTick ();
+
+	/// Retained for existing sketches.  The 32-bit clock needs no normalizing;
+	/// compare times with timerBefore () instead.
+	/**
+		\param time is usually a timeout value.
+		\return time unchanged.
+	*/
+	timerTime_t normalizeTimeOut (const timerTime_t time) const {return time;}
+
+	/// Request the presentTime of the interrupt clock.  When tickless, the clock is
+	/// read from the hardware counter between interrupts.
 	/**
-		\param time is usually a timeout value with 0 most significant bit.
-		\return a value greater than presentTime even if setting the most significant
-				  bit is needed.
+		\return the present tick.
 	*/
-	uint16_t normalizeTimeOut (const uint16_t time) const;
+	timerTime_t getPresentTime () const;
 
-	/// Request the presentTime of the interrupt clock.
+	/// Request the tick at which the timer being called back was due.  It can be
+	/// earlier than getPresentTime () and than the timer's getTimeOut () less its
+	/// period, since the overrun policy may have moved the timeOut further on.
 	/**
-		\return _presentTime
+		\return the due tick; meaningful only in a callback called by the ISR.
 	*/
-	uint16_t getPresentTime () const {return _presentTime;}
+	timerTime_t getDueTime () const {return _due;}
+
+	/// Read the clock to the count of the hardware counter.
+	uint32_t now () const;
+
+	/// Request the microseconds since the Timer started.
+	uint32_t micros () const;
+
+	/// Request the milliseconds since the Timer started.
+	uint32_t millis () const;
+
+	/// Wait for a number of milliseconds.
+	void delay (uint32_t ms);
+
+	/// Asks whether an interval has passed since a mark, moving the mark on if so.
+	bool elapsed (uint32_t &mark, const uint32_t ms) const;
 
-	/// Request the number of timers already started and store in the ordered list.
+	/// Make a wait of some ticks for a TimerThread or a TimerCoroutine.
 	/**
-		\return _timeOutList.GetCount ()
+		\param ticks is the wait, counted from the end of the sequence's previous one.
+		\return the wait, to TIMER_AWAIT () or co_await.
 	*/
-	uint8_t  getCount () const {return _timeOutList.GetCount ();}
+	timerSleep_t sleep (const timerTime_t ticks) {return timerSleep_t {*this, ticks, false};}
 
-	/// Request the timeout time for an indexed timer.
+	/// Request the number of timers already started.
 	/**
-		\param i is the index of the relevant timer in the timeOutList.
-		\return the value of presentTime needed for the timer to expire.
+		\return _queue.GetCount ()
 	*/
-	uint16_t getTimeOut (uint8_t i) {return GET_TIMEOUT (i);}
+	uint16_t getCount () const {return _queue.GetCount ();}
 
-	/// Asks whether the timeOutList is full or whether more timers can be started.
+#if TIMER_BOUNDED
+	/// Asks whether more timers can be started.
 	/**
-		\return true if no more timers can be started or false if the list has more space.
+		\return true if TIMER_HEAP_SIZE timers are running.
 	*/
-	bool isFull () const {return _timeOutList.isFull ();}
+	bool isFull () const {return _queue.isFull ();}
+#else
+	/// Asks whether more timers can be started.  The queue is never full; the
+	/// function remains for existing sketches.
+	/**
+		\return false.
+	*/
+	bool isFull () const {return false;}
+#endif
+
+#if TIMER_ENGINE == TIMER_ENGINE_LIST
+	/// Request the timeout time for an indexed timer.  The queue is walked from
+	/// its head, so this takes time proportional to i.
+	/**
+		\param i is the index of the relevant timer in timeOut order.
+		\return the value of presentTime needed for the timer to expire, or 0 if
+				  fewer than i + 1 timers are running.
+	*/
+	timerTime_t getTimeOut (uint16_t i);
+#endif
 
 protected:
-	inline void NextTick ();   ///< Called by ISR to increment _presentTime & call back
-	uint8_t Search (const p_timeElement pArg); ///< Find _timeOutList insertion for pArg.
-	void InsertTimer (const p_timeElement pArg);	///< Find the correct place in timeOutList
-										///< for the timer pointed to by pArg and insert it into the list.
+	/// Empty the queue without touching the hardware; for TimerT.
+	Timer (p_timeElement *heap, uint16_t capacity, uint16_t (*stamp) (), uint8_t countShift);
+
+	/// Called by the ISR to increment _presentTime and call back.  Hw describes the
+	/// counter that drives the Timer, as TimerHw<> does; its static members are
+	/// compiled into the ISR, so the counter is read and acknowledged directly.
+	template <class Hw> void NextTick ();
+#if TIMER_TICKLESS || TIMER_AUTOSCALE
+	template <class Hw> inline void Advance (const timerTime_t now);	///< Step presentTime to now, expiring on the way.
+#endif
+	template <class Hw> inline void Expire (const timerTime_t now);	///< Call back and re-queue the timers due by now.
+	template <class Hw> inline void Fire (const p_timeElement pTE, const timerTime_t now);	///< Call back and re-queue one.
+#if TIMER_STAGE
+	inline void Commit ();		///< Apply the staged updates.
+#endif
+	inline bool Alarm (const p_timeElement pTE);	///< Call back now or queue for dispatch ().
+	timerTime_t TicksToNext ();	///< Ticks from _presentTime until a timer needs attention.
+#if TIMER_TICKLESS
+	uint16_t HardwareCount (uint32_t &epoch) const;	///< Read TCNT1 and the overflow count.
+	timerTime_t HardwareTime () const;	///< The present tick according to the counter.
+	void ArmCompare ();			///< Program compare match A for the next due timer.
+#endif
+	inline timerTime_t Now () const;	///< The present tick; call with interrupts disabled.
+	virtual uint8_t SleepMode () const;	///< The deepest sleep mode that keeps the clock running.
+	inline uint16_t TickStamp (const timerTime_t tick) const;	///< The stamp at which a tick began.
+	inline uint16_t CountsPerTick () const;	///< Counts of the hardware counter in one tick.
+	uint64_t Counts () const;	///< Counts since the start; call with interrupts disabled.
+	uint64_t Microseconds () const;	///< Microseconds since the start.
+	inline uint32_t TickCycles () const;	///< CPU cycles between interrupts.
+#if TIMER_AUTOSCALE
+	inline void Claim (const p_timeElement pTE);	///< Count a queued timer at its scale.
+	inline void Release (const p_timeElement pTE);	///< Stop counting a timer.
+	inline void Rescale ();		///< Move to a coarser prescaler if the timers allow.
+	void Prescale (const uint8_t code);	///< Switch the prescaler, keeping the clock.
+#endif
+#if TIMER_TRACE
+	inline void Trace (const uint8_t kind, const p_timeElement pTE, const uint8_t data, const uint16_t stamp);	///< Record an event.
+	uint16_t TraceHeader (uint8_t header [10]);	///< Encode a dump's header; the records to follow.
+	void TraceRecord (uint8_t record [8]);		///< Take and encode the oldest record.
+#endif
+#if TIMER_SLACK
+	inline void Align (const p_timeElement pTE);	///< Move a timer's timeOut within its slack.
+#endif
+	bool InsertTimer (const p_timeElement pArg);	///< Find the correct place in the queue
+										///< for the timer pointed to by pArg and insert it there.
+	uint8_t InsertTimers (const p_timeElement te, const uint8_t n);	///< Insert a group of timers.
 
 private:
-	List _timeOutList;   ///< Stores pointers to timeElement structures
-	uint16_t _presentTime;	///< The interrupt clock.
+#if TIMER_ENGINE == TIMER_ENGINE_WHEEL
+	TimerWheel _queue;	///< Holds the running timeElements.
+#elif TIMER_ENGINE == TIMER_ENGINE_HEAP
+	TimerHeap _queue;		///< Holds the running timeElements in heap order.
+#else
+	TimerQueue _queue;	///< Holds the running timeElements in timeOut order.
+#endif
+	p_timeElement _current;	///< The timer whose callback is executing; 0 if canceled.
+	timerTime_t _due;			///< The tick at which _current was due.
+	volatile uint8_t _fired;	///< Callbacks run by the ISR, modulo 256; see idleUntilNextTimer ().
+	timerTime_t _presentTime;	///< The interrupt clock.
+	bool _ownsClock;			///< The constructor configured the hardware, so the destructor stops it.
+#if TIMER_TICKLESS
+	uint32_t _epoch;		///< Number of Timer/Counter 1 overflows; the high words of the count.
+	uint8_t _tickShift;	///< log2 of the counts per tick.
+	uint8_t _margin;		///< Counts the compare must lie ahead of the counter to be seen.
+#endif
+#if TIMER_DEFER
+	TimerRing<p_timeElement, TIMER_DEFER_SIZE> _deferQueue;	///< Expired timers awaiting dispatch ().
+#endif
+#if TIMER_STAGE
+	TimerRing<timerUpdate_t, TIMER_STAGE_SIZE> _stageQueue;	///< Updates awaiting the ISR.
+#endif
+	timerStamp_t _stamp;		///< Reads the hardware counter that drives this Timer.
+	uint8_t _countShift;		///< log2 of the CPU cycles in one count of the counter.
+#if !TIMER_TICKLESS
+	uint16_t _era;				///< Times _presentTime has wrapped; extends the clock for millis ().
+	timerTime_t _lead;		///< Ticks the counter's present tick began after _presentTime.
+#endif
+#if TIMER_AUTOSCALE
+	uint8_t _prescaler;		///< The prescaler code Timer/Counter 2 runs at.
+	uint8_t _target;			///< The coarsest code every running timer allows.
+	uint16_t _residue;		///< CPU cycles passed that the counter does not show.
+	uint16_t _running [7];	///< Running timers by scale, the prescaler code less one.
+#endif
+#if TIMER_STATS
+	timerStats_t _stats;		///< ISR load, queue depth and overruns.
+#endif
+#if TIMER_TRACE
+	TimerTrace<TIMER_TRACE_SIZE> _trace;	///< The latest events.
+#endif
 };
 
 //extern Timer timer;
@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerCoroutine.cpp - Sequences that wait on timer.sleep () without a stack.
+/// See TimerCoroutine.h for usage.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "TimerCoroutine.h"
+
+/// Start the timer so that the sequence goes on when the wait ends.  The first wait
+/// after a stop counts from the present tick; each later one from the end of the
+/// one before, so that late steps do not delay the rest.  A wake already past
+/// comes at the next tick.
+/**
+	\param s is the wait.
+	\return false if the Timer had no room; the sequence is then stopped.
+*/
+bool TimerSleeper::Sleep (const timerSleep_t &s)
+{
+	bool queued;
+
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		_wake = (_owner ? _wake : s.timer.getPresentTime ()) + s.ticks;
+		_timer.setPeriod (s.ticks);		// Repeats are 0; each step reschedules the timer.
+		queued = s.timer.rescheduleTimer (&_timer, _wake);
+		_owner = queued ? &s.timer : 0;
+	}
+	return queued;
+}
+
+/// Cancel the wait.  From the sequence's own step, this keeps the ISR from
+/// re-queuing the timer when the step returns.
+void TimerSleeper::Stop ()
+{
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		if (_owner)
+			_owner->cancelTimer (&_timer);
+		_owner = 0;
+	}
+}
+
+/// Stop the sequence if it runs, then run it from the top up to its first wait.
+void TimerThread::start ()
+{
+	cancel ();
+	run ();
+}
+
+/// Stop the sequence.  The next start () runs it from the top.
+void TimerThread::cancel ()
+{
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		Finish ();
+}
+
+/// The callback of the thread's timer:  run the next step of the sequence.
+/**
+	\param thread is the TimerThread.
+*/
+void TimerThread::Resume (void *thread)
+{
+	static_cast<TimerThread *> (thread)->run ();
+}
@@ -0,0 +1,242 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerCoroutine.h - Sequences that wait on timer.sleep () without a stack.
+///
+/// Usage:  1  Derive from TimerThread and write the sequence in run () between
+///            TIMER_THREAD_BEGIN () and TIMER_THREAD_END ().  TIMER_AWAIT () returns
+///            from run () and the expiry of the wait calls run () again, which goes
+///            on after the TIMER_AWAIT ():
+///
+///					class Pulse : public TimerThread {
+///						void run () {
+///							TIMER_THREAD_BEGIN ();
+///							for (;;) {
+///								digitalWrite (13, HIGH);
+///								TIMER_AWAIT (timer.sleep (20));
+///								level = analogRead (A0);
+///								digitalWrite (13, LOW);
+///								TIMER_AWAIT (timer.sleep (5));
+///							}
+///							TIMER_THREAD_END ();
+///						}
+///					} pulse;
+///
+///				Call pulse.start () to run it from the top and pulse.cancel () to
+///				stop it.  Local variables do not survive a TIMER_AWAIT (); keep
+///				state in members.  At most one TIMER_AWAIT () may share a line, and
+///				run () may not contain a switch statement of its own around one.
+///         2  With C++20 coroutines (TIMER_COROUTINES is then 1), a function
+///				returning a TimerCoroutine does the same with co_await:
+///
+///					TimerCoroutine pulse (uint8_t pin) {
+///						for (;;) {
+///							digitalWrite (pin, HIGH);
+///							co_await timer.sleep (20);
+///							digitalWrite (pin, LOW);
+///							co_await timer.sleep (5);
+///						}
+///					}
+///
+///					TimerCoroutine p = pulse (13);
+///
+///				Locals survive, in the coroutine's frame, which the compiler
+///				allocates with new.  Destroying the TimerCoroutine stops the
+///				sequence and frees the frame.
+///
+/// A sequence runs up to its first wait when started, in the caller's context, and
+/// from then on in the callback of its timer, like any timer callback.  Each wait
+/// counts from the end of the previous one, not from when the step ran, so the
+/// sequence keeps its rhythm however late its steps run.  A wait is at least until
+/// the next tick.  If the Timer has no room for the wait (the heap engine),
+/// a TimerThread stops and co_await returns false at once.
+///
+/// Either kind keeps one timeElement, the time it is due to wake and its place in
+/// the sequence:  a few bytes for each of any number of sequences, which share the
+/// one stack.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_COROUTINE_H
+#define TIMER_COROUTINE_H
+
+#include "Timer.h"
+
+#ifndef TIMER_COROUTINES
+	#if defined (__cpp_impl_coroutine) && defined (__has_include)
+		#if __has_include (<coroutine>)
+			#define TIMER_COROUTINES 1
+		#endif
+	#endif
+#endif
+#ifndef TIMER_COROUTINES
+	#define TIMER_COROUTINES 0
+#endif
+
+#if TIMER_COROUTINES
+	#include <coroutine>
+#endif
+
+/// What a sequence keeps between its steps:  the timer that resumes it and the
+/// tick it is due to wake.
+class TimerSleeper
+{
+public:
+	/// Schedule the next step.
+	bool Sleep (const timerSleep_t &s);
+
+protected:
+	/// The constructor binds the timer to the function that resumes the sequence.
+	/**
+		\param resume is called when a wait ends.
+		\param arg is passed to resume.
+	*/
+	TimerSleeper (timerCallBack_t resume, void *arg) : _owner (0), _wake (0)
+	{
+		_timer.setCallBack (resume, arg);
+	}
+
+	/// Cancel the wait, if any.
+	void Stop ();
+
+	/// Ask whether a wait is pending.
+	/**
+		\return true from a successful wait until the sequence ends or is stopped.
+	*/
+	bool Sleeping () const {return 0 != _owner;}
+
+private:
+	timeElement _timer;		///< Expires at the end of the wait.
+	Timer *_owner;			///< The Timer of the last wait, or 0 if not sleeping.
+	timerTime_t _wake;		///< The tick the last wait ends.
+};
+
+/// A protothread:  a sequence whose place is a line number kept between calls.
+class TimerThread : protected TimerSleeper
+{
+public:
+	/// The constructor leaves the sequence stopped.
+	TimerThread () : TimerSleeper (Resume, this), _line (0) {}
+
+	/// The destructor stops the sequence.
+	virtual ~TimerThread () {cancel ();}
+
+	/// Run the sequence from the top, up to its first wait.
+	void start ();
+
+	/// Stop the sequence.
+	void cancel ();
+
+	/// Ask whether the sequence is waiting to go on.
+	/**
+		\return false before start (), after TIMER_THREAD_END () and after cancel ().
+	*/
+	bool isRunning () const {return Sleeping ();}
+
+protected:
+	/// The sequence, written between TIMER_THREAD_BEGIN () and TIMER_THREAD_END ().
+	virtual void run () = 0;
+
+	/// Schedule the next step; used by TIMER_AWAIT ().
+	/**
+		\param s is the wait.
+		\param line is where the sequence goes on.
+	*/
+	void Await (const timerSleep_t &s, uint16_t line)
+	{
+		_line = line;		// Before Sleep (); the ISR may call run () from then on.
+		if (!Sleep (s))
+			_line = 0;
+	}
+
+	/// End the sequence; used by TIMER_THREAD_END ().
+	void Finish () {Stop (); _line = 0;}
+
+	uint16_t _line;			///< Where run () goes on; 0 = the top.
+
+private:
+	static void Resume (void *thread);	///< The callback of the timer.
+};
+
+/// Begin the sequence in TimerThread.run ().
+#define TIMER_THREAD_BEGIN()	switch (_line) {case 0:
+
+/// Wait for a timerSleep_t, usually timer.sleep (ticks), and go on from here.
+#define TIMER_AWAIT(s)			do {Await ((s), __LINE__); return; case __LINE__:;} while (0)
+
+/// End the sequence in TimerThread.run ().
+#define TIMER_THREAD_END()		} Finish ()
+
+#if TIMER_COROUTINES
+/// The return type of a C++20 coroutine that waits on timer.sleep ().
+class TimerCoroutine
+{
+public:
+	/// The state the compiler keeps in the coroutine's frame.
+	struct promise_type : TimerSleeper
+	{
+		promise_type () : TimerSleeper (Resume, this) {}
+
+		TimerCoroutine get_return_object () {return TimerCoroutine (handle_t::from_promise (*this));}
+		std::suspend_never initial_suspend () noexcept {return {};}
+		std::suspend_always final_suspend () noexcept {return {};}	///< The TimerCoroutine frees the frame.
+		void return_void () {Stop ();}
+		void unhandled_exception () {}
+
+		/// The callback of the timer.
+		static void Resume (void *promise)
+		{
+			handle_t::from_promise (*static_cast<promise_type *> (promise)).resume ();
+		}
+
+		using TimerSleeper::Stop;
+		using TimerSleeper::Sleeping;
+	};
+
+	typedef std::coroutine_handle<promise_type> handle_t;	///< The handle of the frame.
+
+	/// Take over the frame of another TimerCoroutine.
+	TimerCoroutine (TimerCoroutine &&c) : _handle (c._handle) {c._handle = 0;}
+
+	/// Stop the sequence, if it still runs, and free its frame.
+	~TimerCoroutine () {cancel (); if (_handle) _handle.destroy ();}
+
+	TimerCoroutine (const TimerCoroutine &) = delete;
+	TimerCoroutine &operator= (const TimerCoroutine &) = delete;
+
+	/// Stop the sequence.  It is not resumed again; its frame lasts until the
+	/// TimerCoroutine is destroyed.
+	void cancel ()
+	{
+		if (_handle)
+			ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+				_handle.promise ().Stop ();
+	}
+
+	/// Ask whether the sequence is waiting to go on.
+	/**
+		\return false once the coroutine has returned or was canceled.
+	*/
+	bool isRunning () const
+	{
+		bool sleeping = false;
+
+		if (_handle)
+			ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+				sleeping = _handle.promise ().Sleeping ();
+		return sleeping;
+	}
+
+private:
+	explicit TimerCoroutine (handle_t h) : _handle (h) {}
+
+	handle_t _handle;		///< The coroutine's frame.
+};
+#endif
+
+#endif // TIMER_COROUTINE_H
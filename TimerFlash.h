@@ -0,0 +1,193 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerFlash.h - A fixed schedule of timers kept in flash.
+///
+/// Usage:  1  Write the schedule as a table in flash, one timerSchedule_t per timer:
+///
+///					const timerSchedule_t blinks [3] PROGMEM = {
+///						{0xF400, 0, callBack, &led [0], 0},
+///						{0x7A00, 0, callBack, &led [1], 0},
+///						{0x5100, 0, callBack, &led [2], 0x2000}};
+///
+///				Each entry gives the period, repeats (0 = forever), callback,
+///				argument and a phase that delays the first expiration only.
+///         2  Instantiate TimerFlash<N> at file scope with the Timer that runs it:
+///
+///					TimerFlash<3> blinkers (timer, blinks);
+///
+///         3  Call blinkers.start () to start every entry from the same tick, and
+///				blinkers.stop () to stop them all.
+///
+/// The period, repeats, callback and argument stay in flash and are read by the ISR
+/// when an entry is due.  SRAM holds only each entry's next deadline and remaining
+/// repeats, 6 bytes on the AVR, against 21 for a timeElement, and one timeElement
+/// for the whole schedule.  That timeElement is the schedule's only place in the
+/// queue, due at the earliest deadline of its entries, so starting the schedule
+/// costs one insertion however many entries it has.  When it expires, it calls
+/// back every entry due, in table order, and scans the deadlines for the next; an
+/// expiration costs O(N).  A late entry catches up, one expiration a tick, as
+/// TIMER_CATCHUP does.  An entry of period 0 expires on every tick.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_FLASH_H
+#define TIMER_FLASH_H
+
+#include "Timer.h"
+
+/// One timer of a schedule kept in flash (PROGMEM); see TimerFlash.
+struct timerSchedule_t
+{
+	timerTime_t period;			///< Ticks between callbacks.
+	uint16_t repeats;			///< Expirations before the timer stops; 0 = never.
+	timerCallBack_t callBack;	///< The function called when the timer expires.
+	void *arg;					///< The argument passed to callBack.
+	timerTime_t phase;			///< Ticks added to the first period only.
+};
+
+template <uint8_t N>
+class TimerFlash
+{
+	static_assert (N > 0, "a TimerFlash has at least one entry");
+
+public:
+	/// The constructor leaves the schedule stopped.
+	/**
+		\param timer is the Timer that runs the schedule.
+		\param schedule is the table of N entries in PROGMEM.
+	*/
+	TimerFlash (Timer &timer, const timerSchedule_t (&schedule) [N])
+		: _timer (timer), _schedule (schedule), _driver (1, 0)
+	{
+		_driver.setCallBack (Expired, this);
+		for (uint8_t i=0; i<N; i++)
+			_left [i] = 0;
+	}
+
+	/// Start every entry from the present tick.  The first expiration of each is its
+	/// phase plus its period later.  A running schedule is restarted.
+	/**
+		\return false if the Timer is full and the schedule did not start.
+	*/
+	bool start ()
+	{
+		bool started;
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		{
+			timerTime_t now = _timer.getPresentTime ();
+			timerTime_t next = 0, align = 0;
+
+			for (uint8_t i=0; i<N; i++)
+			{
+				const timerSchedule_t *e = &_schedule [i];
+				timerTime_t period = pgm_read_dword (&e->period);
+				timerTime_t phase = pgm_read_dword (&e->phase);
+				uint16_t repeats = pgm_read_word (&e->repeats);
+
+				_timeOut [i] = now + phase + period;
+				_left [i] = repeats ? repeats : 1;	// An entry that never stops is never counted down.
+				if (0 == i || timerBefore (_timeOut [i], next))
+					next = _timeOut [i];
+				align |= period ? period | phase : 1;
+			}
+			_driver.setPeriod (align);		// The ticks the deadlines can fall on, for TIMER_AUTOSCALE.
+			started = _timer.rescheduleTimer (&_driver, next);
+			if (!started)
+				Clear ();
+		}
+		return started;
+	}
+
+	/// Stop every entry.
+	void stop ()
+	{
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		{
+			_timer.cancelTimer (&_driver);
+			Clear ();
+		}
+	}
+
+	/// Asks whether any entry is still running.
+	/**
+		\return true if an entry has neither finished nor been stopped, including
+				  while the callbacks run.
+	*/
+	bool isRunning () const
+	{
+		bool running = false;
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		{
+			for (uint8_t i=0; i<N && !running; i++)
+				running = 0 != _left [i];
+		}
+		return running;
+	}
+
+private:
+	/// Mark every entry stopped.
+	void Clear ()
+	{
+		for (uint8_t i=0; i<N; i++)
+			_left [i] = 0;
+	}
+
+	/// The callback of the schedule's timeElement:  call back every entry due, then
+	/// move the timeElement to the earliest deadline left, or stop it if none is.  An
+	/// entry's deadline and repeats are counted before its callback runs, so the
+	/// callback may stop or restart the schedule.
+	/**
+		\param flash is the TimerFlash.
+	*/
+	static void Expired (void *flash)
+	{
+		TimerFlash *s = static_cast<TimerFlash *> (flash);
+		timerTime_t now = s->_timer.getPresentTime ();
+
+		for (uint8_t i=0; i<N; i++)
+		{
+			if (0 == s->_left [i] || timerBefore (now, s->_timeOut [i]))
+				continue;
+
+			const timerSchedule_t *e = &s->_schedule [i];
+			timerTime_t period = pgm_read_dword (&e->period);
+
+			if (0 != pgm_read_word (&e->repeats))
+				s->_left [i]--;
+			s->_timeOut [i] = period ? s->_timeOut [i] + period : now + 1;
+			((timerCallBack_t) pgm_read_ptr (&e->callBack)) (pgm_read_ptr (&e->arg));
+		}
+
+		bool any = false;
+		timerTime_t next = 0;
+
+		for (uint8_t i=0; i<N; i++)
+		{
+			if (0 != s->_left [i] && (!any || timerBefore (s->_timeOut [i], next)))
+			{
+				next = s->_timeOut [i];
+				any = true;
+			}
+		}
+		if (any)
+			s->_driver.modifyTimeOut (next);
+		else
+			s->_timer.cancelTimer (&s->_driver);	// Not re-queued.
+	}
+
+	Timer &_timer;						///< The Timer that runs the schedule.
+	const timerSchedule_t *_schedule;	///< The table, in PROGMEM.
+	timeElement _driver;				///< Due at the earliest deadline of the entries.
+	timerTime_t _timeOut [N];			///< The next deadline of each entry.
+	uint16_t _left [N];					///< Expirations left to each entry; 0 = stopped.
+};
+
+#endif // TIMER_FLASH_H
@@ -0,0 +1,40 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerHal.h - Hardware abstraction for the Timer library.
+///
+/// The Timer classes and their engines reach the hardware only through the names
+/// defined by avr-libc and the Arduino core:  the Timer/Counter registers (TCCR2A,
+/// TCCR2B, TCNT2, TIMSK2, TIFR2, GTCCR, ...), SREG, ATOMIC_BLOCK, ISR (),
+/// noInterrupts (), PROGMEM with pgm_read_word (), pgm_read_dword () and
+/// pgm_read_ptr (), _NOP () and the sleep macros.
+/// This header selects where those names come from.
+///
+///		__AVR__ defined		The real registers from <avr/io.h> and friends.
+///		otherwise			The virtual Timer/Counter of TimerSim.h so that the
+///								library can be built, exercised and benchmarked on a
+///								Linux host.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_HAL_H
+#define TIMER_HAL_H
+
+#if defined (__AVR__)
+	#include <Arduino.h>
+	#include <avr/io.h>
+	#include <avr/cpufunc.h>
+	#include <avr/interrupt.h>
+	#include <avr/pgmspace.h>
+	#include <avr/sleep.h>
+	#include <util/atomic.h>
+#else
+	#include "TimerSim.h"
+#endif
+
+#endif // TIMER_HAL_H
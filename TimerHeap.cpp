@@ -0,0 +1,166 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerHeap.cpp - Source file for the binary min-heap timer queue.
+///
+/// See TimerHeap.h.  The heap is only compiled when TIMER_ENGINE selects it.
+/// Position i has children 2i + 1 and 2i + 2; a timeElement's _heapIndex is its
+/// position plus one so that 0 means "not in the heap".
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "Timer.h"
+
+#if TIMER_ENGINE == TIMER_ENGINE_HEAP
+
+/// Store a timer at a position and record the position in the timer.
+inline void TimerHeap::Place (uint16_t i, const p_timeElement pTE)
+{
+	_heap [i] = pTE;
+	pTE->_heapIndex = i + 1;
+}
+
+/// Move the timer at position i up past every parent due later than it.
+void TimerHeap::SiftUp (uint16_t i)
+{
+	p_timeElement pTE = _heap [i];
+
+	while (i > 0)
+	{
+		uint16_t parent = (i - 1) / 2;
+
+		if (!timerBefore (pTE->_timeOut, _heap [parent]->_timeOut))
+			break;
+		Place (i, _heap [parent]);
+		i = parent;
+	}
+	Place (i, pTE);
+}
+
+/// Move the timer at position i down past every child due earlier than it.
+void TimerHeap::SiftDown (uint16_t i)
+{
+	p_timeElement pTE = _heap [i];
+
+	for (;;)
+	{
+		uint16_t child = 2 * i + 1;
+
+		if (child >= _count)
+			break;
+		if (child + 1 < _count && timerBefore (_heap [child + 1]->_timeOut, _heap [child]->_timeOut))
+			child++;
+		if (!timerBefore (_heap [child]->_timeOut, pTE->_timeOut))
+			break;
+		Place (i, _heap [child]);
+		i = child;
+	}
+	Place (i, pTE);
+}
+
+/// Append a timer and sift it up.
+/**
+	\param pTE points to a timeElement that is not already in the heap.
+	\return false if the heap is full and pTE was not added.
+*/
+bool TimerHeap::Insert (const p_timeElement pTE)
+{
+	if (isFull ())
+		return false;
+
+	_heap [_count] = pTE;
+	SiftUp (_count++);
+	return true;
+}
+
+/// Fill the timer's position with the last timer and sift that one whichever way
+/// it needs to go.  Timers not in the heap are ignored.
+/**
+	\param pTE points to the timeElement to be removed.
+*/
+void TimerHeap::Remove (const p_timeElement pTE)
+{
+	if (!Contains (pTE))
+		return;
+
+	uint16_t i = pTE->_heapIndex - 1;
+
+	pTE->_heapIndex = 0;
+	if (i != --_count)
+	{
+		Place (i, _heap [_count]);
+		Update (_heap [i]);
+	}
+}
+
+/// Restore heap order after a timer's timeOut changed in either direction.
+/**
+	\param pTE points to the timeElement whose timeOut changed.
+*/
+void TimerHeap::Update (const p_timeElement pTE)
+{
+	uint16_t i = pTE->_heapIndex - 1;
+
+	if (i > 0 && timerBefore (pTE->_timeOut, _heap [(i - 1) / 2]->_timeOut))
+		SiftUp (i);
+	else
+		SiftDown (i);
+}
+
+/// Take the root of the heap if its timeOut is now or has passed.
+/**
+	\param now is the present time.
+	\return a pointer to the removed timeElement, or 0 if none is due.
+*/
+p_timeElement TimerHeap::Pop (const timerTime_t now)
+{
+	p_timeElement pTE = Head ();
+
+	if (0 == pTE || timerBefore (now, pTE->_timeOut))
+		return 0;
+
+	Remove (pTE);
+	return pTE;
+}
+
+/// Scan the heap for the earliest timeOut within a window.  Heap order does not
+/// help here, so this takes time proportional to the number of timers.
+/**
+	\param lo is the start of the window.
+	\param hi is the end of the window, inclusive.
+	\param t receives the timeOut found.
+	\return true if a timer is due within the window.
+*/
+bool TimerHeap::Find (const timerTime_t lo, const timerTime_t hi, timerTime_t &t) const
+{
+	bool found = false;
+
+	for (uint16_t i=0; i<_count; i++)
+	{
+		timerTime_t to = _heap [i]->_timeOut;
+
+		if (!timerBefore (to, lo) && !timerBefore (hi, to) && (!found || timerBefore (to, t)))
+		{
+			t = to;
+			found = true;
+		}
+	}
+	return found;
+}
+
+/// Asks whether a timer is in the heap.
+/**
+	\param pTE points to the timeElement in question.
+	\return true if pTE is in the heap.
+*/
+bool TimerHeap::Contains (const p_timeElement pTE)
+{
+	return 0 != pTE->_heapIndex;
+}
+
+#endif // TIMER_ENGINE_HEAP
@@ -0,0 +1,123 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerHeap.h - Header file for the binary min-heap timer queue.
+///
+/// The heap is the queue behind Timer when TIMER_ENGINE is TIMER_ENGINE_HEAP.  It
+/// is an array of timeElement pointers kept in heap order by timeOut:  no timer is
+/// due before its parent, so the root is the next timer due.  The array belongs to
+/// the Timer, which sizes it with TIMER_HEAP_SIZE or the TimerT Capacity.
+/// Every timeElement records its own position in the array, so
+///
+///		Insert		O(log n)	append and sift up,
+///		Remove		O(log n)	move the last timer into the hole and sift,
+///		Update		O(log n)	sift a timer whose timeOut changed,
+///		Pop			O(log n)	remove the root if it is due.
+///
+/// Unlike the sorted queue, timers with equal timeOuts expire in no particular
+/// order.  RAM cost is one pointer per timer of capacity plus an index in each
+/// timeElement.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_HEAP_H
+#define TIMER_HEAP_H
+
+#include <inttypes.h>
+
+#ifndef TIMER_HEAP_SIZE
+	#define TIMER_HEAP_SIZE 16		///< Maximum number of timers running on a Timer.
+#endif
+
+class timeElement;
+typedef timeElement *p_timeElement;
+typedef uint32_t timerTime_t;
+
+class TimerHeap
+{
+public:
+	/// Constructor empties the heap.
+	/**
+		\param heap points to the array that will hold the timer pointers.
+		\param size is the number of pointers the array holds.
+	*/
+	TimerHeap (p_timeElement *heap, uint16_t size) : _heap (heap), _size (size), _count (0) {}
+
+	/// Add a timer to the heap.
+	/**
+		\param pTE points to a timeElement that is not already in the heap.
+		\return false if the heap is full and pTE was not added.
+	*/
+	bool Insert (const p_timeElement pTE);
+
+	/// Take a timer out of the heap.  Timers not in the heap are ignored.
+	/**
+		\param pTE points to the timeElement to be removed.
+	*/
+	void Remove (const p_timeElement pTE);
+
+	/// Restore heap order after the timeOut of a timer in the heap has changed.
+	/**
+		\param pTE points to the timeElement whose timeOut changed.
+	*/
+	void Update (const p_timeElement pTE);
+
+	/// Take the root of the heap if it is due.
+	/**
+		\param now is the present time.
+		\return a pointer to the removed timeElement whose timeOut is not after now, or 0.
+	*/
+	p_timeElement Pop (const timerTime_t now);
+
+	/// Request the timer that expires first.
+	/**
+		\return a pointer to the root of the heap, or 0 if the heap is empty.
+	*/
+	p_timeElement Head () const {return _count ? _heap [0] : 0;}
+
+	/// Find the earliest timeOut of a queued timer within a window.  Used to
+	/// coalesce timers that have slack (TIMER_SLACK).
+	/**
+		\param lo is the start of the window.
+		\param hi is the end of the window, inclusive.
+		\param t receives the timeOut found.
+		\return true if a timer is due within the window.
+	*/
+	bool Find (const timerTime_t lo, const timerTime_t hi, timerTime_t &t) const;
+
+	/// Asks whether a timer is in the heap.
+	/**
+		\param pTE points to the timeElement in question.
+		\return true if pTE is in the heap.
+	*/
+	static bool Contains (const p_timeElement pTE);
+
+	/// Retrieve the number of timers in the heap.
+	/**
+		\return the number of timers in the heap.
+	*/
+	uint16_t GetCount () const {return _count;}
+
+	/// Asks whether the heap is full.
+	/**
+		\return true if no more timers can be inserted.
+	*/
+	bool isFull () const {return _size == _count;}
+
+protected:
+	void Place (uint16_t i, const p_timeElement pTE);	///< Store pTE at position i.
+	void SiftUp (uint16_t i);		///< Move the timer at i toward the root.
+	void SiftDown (uint16_t i);	///< Move the timer at i toward the leaves.
+
+private:
+	p_timeElement *_heap;	///< _heap [0] is due first.
+	uint16_t _size;		///< Capacity of _heap.
+	uint16_t _count;		///< Number of timers in the heap.
+};
+
+#endif // TIMER_HEAP_H
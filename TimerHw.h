@@ -0,0 +1,230 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerHw.h - Compile-time descriptions of the hardware timers that can drive a
+/// TimerT.
+///
+/// TimerHw<N> describes Timer/Counter N.  Each specialization maps a prescaler
+/// division to its clock select (CS) bits and writes the registers so that the
+/// counter interrupts once every 256 prescaled clocks, the tick length of Timer.h:
+///
+///		TimerHw<0>	8-bit Timer/Counter 0 as the Arduino core runs it for millis ():
+///						fast PWM, division 64.  The tick is compare match A, which
+///						comes once per count cycle whatever OCR0A holds, so neither the
+///						core's overflow ISR nor PWM on OC0A is disturbed.  The
+///						division cannot be changed without upsetting millis ().
+///		TimerHw<1>	16-bit Timer/Counter 1 in CTC mode with OCR1A = 255; the tick is
+///						compare match A.  Divisions 1, 8, 64, 256 and 1024.
+///		TimerHw<2>	8-bit Timer/Counter 2 in normal mode; the tick is the overflow.
+///						Divisions 1, 8, 32, 64, 128, 256 and 1024.
+///
+/// Every member is static and the arguments are constants, so the register writes
+/// compile to immediate stores.  stamp () serves TIMER_STATS (see TimerStats.h):
+/// the count is read again once a pending tick is seen, so a tick that begins
+/// between the two register reads is not missed.  takeTick () clears the flag of
+/// a pending tick for the ISR, which counts it at once.  sleepMode () names the
+/// deepest sleep mode in which the counter keeps counting, for
+/// Timer::idleUntilNextTimer ():  idle for a counter on the I/O clock, power-save
+/// for Timer/Counter 2 when it runs from its own crystal (AS2 set in ASSR).
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_HW_H
+#define TIMER_HW_H
+
+#include <inttypes.h>
+#include "TimerHal.h"
+
+template <uint8_t N>
+struct TimerHw;
+
+template <>
+struct TimerHw<0>
+{
+	/// Map a prescaler division to the CS bits of TCCR0B.
+	/**
+		\param divisor is the prescaler division.
+		\return the CS bits, or 0 unless divisor is the core's 64.
+	*/
+	static constexpr uint8_t cs (const uint16_t divisor) {return 64 == divisor ? 3 : 0;}
+
+	/// Interrupt on compare match A.  The counter is started only if nothing (such
+	/// as the Arduino core's init ()) has started it already.
+	/**
+		\param cs is the value returned by cs ().
+	*/
+	static void begin (const uint8_t cs)
+	{
+		if (0 == (TCCR0B & 0x07))
+			TCCR0B = cs;
+		TIMSK0 = (uint8_t) (TIMSK0 | (1 << OCIE0A));
+	}
+
+	/// Disable the interrupt, leaving the counter to the core.
+	static void end () {TIMSK0 = (uint8_t) (TIMSK0 & ~(1 << OCIE0A));}
+
+	/// Read the counts since the last tick, plus 256 if the next tick is pending.
+	static uint16_t stamp ()
+	{
+		uint8_t count = TCNT0 - OCR0A;			// The tick begins at the match.
+
+		if (TIFR0 & (1 << OCF0A))
+			return (uint8_t) (TCNT0 - OCR0A) + 0x100;	// Counted after the pending tick began.
+		return count;
+	}
+
+	/// Acknowledge a tick whose interrupt is pending, so that it can be counted before
+	/// another one sets the flag again.
+	/**
+		\return true if a tick was pending.
+	*/
+	static bool takeTick ()
+	{
+		if (0 == (TIFR0 & (1 << OCF0A)))
+			return false;
+		TIFR0 = 1 << OCF0A;			// Writing a one clears the flag.
+		return true;
+	}
+
+	/// Name the deepest sleep mode that keeps the counter running.
+	/**
+		\return SLEEP_MODE_IDLE; the I/O clock stops in every deeper mode.
+	*/
+	static uint8_t sleepMode () {return SLEEP_MODE_IDLE;}
+};
+
+template <>
+struct TimerHw<1>
+{
+	/// Map a prescaler division to the CS bits of TCCR1B.
+	/**
+		\param divisor is the prescaler division.
+		\return the CS bits, or 0 if Timer/Counter 1 has no such division.
+	*/
+	static constexpr uint8_t cs (const uint16_t divisor)
+	{
+		return 1 == divisor ? 1 : 8 == divisor ? 2 : 64 == divisor ? 3 :
+			256 == divisor ? 4 : 1024 == divisor ? 5 : 0;
+	}
+
+	/// Count from 0 to 255 and interrupt on compare match A.
+	/**
+		\param cs is the value returned by cs ().
+	*/
+	static void begin (const uint8_t cs)
+	{
+		TCCR1A = 0x00;
+		TCCR1B = (1 << WGM12) | cs;
+		OCR1A = 0xff;
+		TCNT1 = 0;
+		TIMSK1 = 1 << OCIE1A;
+	}
+
+	/// Disable the interrupt.
+	static void end () {TIMSK1 = 0;}
+
+	/// Read the counts since the last tick, plus 256 if the next tick is pending.
+	static uint16_t stamp ()
+	{
+		uint8_t count = TCNT1 - OCR1A;			// The tick begins at the match.
+
+		if (TIFR1 & (1 << OCF1A))
+			return (uint8_t) (TCNT1 - OCR1A) + 0x100;	// Counted after the pending tick began.
+		return count;
+	}
+
+	/// Acknowledge a tick whose interrupt is pending, so that it can be counted before
+	/// another one sets the flag again.
+	/**
+		\return true if a tick was pending.
+	*/
+	static bool takeTick ()
+	{
+		if (0 == (TIFR1 & (1 << OCF1A)))
+			return false;
+		TIFR1 = 1 << OCF1A;			// Writing a one clears the flag.
+		return true;
+	}
+
+	/// Name the deepest sleep mode that keeps the counter running.
+	/**
+		\return SLEEP_MODE_IDLE; the I/O clock stops in every deeper mode.
+	*/
+	static uint8_t sleepMode () {return SLEEP_MODE_IDLE;}
+};
+
+template <>
+struct TimerHw<2>
+{
+	/// Map a prescaler division to the CS bits of TCCR2B.
+	/**
+		\param divisor is the prescaler division.
+		\return the CS bits, or 0 if Timer/Counter 2 has no such division.
+	*/
+	static constexpr uint8_t cs (const uint16_t divisor)
+	{
+		return 1 == divisor ? 1 : 8 == divisor ? 2 : 32 == divisor ? 3 : 64 == divisor ? 4 :
+			128 == divisor ? 5 : 256 == divisor ? 6 : 1024 == divisor ? 7 : 0;
+	}
+
+	/// Count from 0 to 255 and interrupt on overflow.
+	/**
+		\param cs is the value returned by cs ().
+	*/
+	static void begin (const uint8_t cs)
+	{
+		TCCR2A = 0x00;
+		TCCR2B = cs;
+		TIMSK2 = 1 << TOIE2;
+	}
+
+	/// Disable the interrupt.
+	static void end () {TIMSK2 = 0;}
+
+	/// Read the counts since the last tick, plus 256 if the next tick is pending.
+	static uint16_t stamp ()
+	{
+		uint8_t count = TCNT2;
+
+		if (TIFR2 & (1 << TOV2))
+			return TCNT2 + 0x100;	// Counted after the pending tick began.
+		return count;
+	}
+
+	/// Acknowledge a tick whose interrupt is pending, so that it can be counted before
+	/// another one sets the flag again.
+	/**
+		\return true if a tick was pending.
+	*/
+	static bool takeTick ()
+	{
+		if (0 == (TIFR2 & (1 << TOV2)))
+			return false;
+		TIFR2 = 1 << TOV2;			// Writing a one clears the flag.
+		return true;
+	}
+
+	/// Name the deepest sleep mode that keeps the counter running.  When the counter
+	/// runs asynchronously, a register is rewritten and its update awaited, since the
+	/// part must not re-enter power-save within one cycle of the crystal of waking.
+	/**
+		\return SLEEP_MODE_PWR_SAVE if the counter has its own clock, or else
+				 SLEEP_MODE_IDLE.
+	*/
+	static uint8_t sleepMode ()
+	{
+		if (0 == (ASSR & (1 << AS2)))
+			return SLEEP_MODE_IDLE;
+		OCR2B = OCR2B;
+		while (ASSR & (1 << OCR2BUB))
+			;
+		return SLEEP_MODE_PWR_SAVE;
+	}
+};
+
+#endif // TIMER_HW_H
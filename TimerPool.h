@@ -0,0 +1,222 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerPool.h - A fixed slab of timeElements addressed by checked handles.
+///
+/// Usage:  1  Instantiate TimerPool<Slots> at file scope with the Timer that runs
+///            its timers, e.g.
+///
+///					TimerPool<8> pool (timer);
+///
+///				The pool holds Slots timeElements, so its RAM is fixed at compile
+///				time and no timeElement can go out of scope while it runs.
+///         2  Start a timer from a parameter struct:
+///
+///					timerHandle_t h = pool.start ({250, 0, blink, &led});
+///
+///				start () takes the first free slot and returns a handle to it, or a
+///				handle whose generation is 0 if every slot is busy or the Timer is
+///				full.
+///         3  Use the handle with cancel (), isRunning () and get (), all O(1).  get ()
+///				returns the timeElement for its modifyXxxx () functions, except
+///				modifyCallBack () and modifyArg ():  the pool calls the callback
+///				itself.  Cancel the timer through the pool, not the Timer.
+///
+/// A slot is busy from start () until its timer is canceled through the pool or
+/// returns from its last callback.  A periodic timer is out of the queue while its
+/// callback runs, and its slot stays busy meanwhile, so a start () from the
+/// callback takes another slot.  Each slot counts generations.  Starting a slot and
+/// canceling it through the pool advance its generation, so a handle kept after
+/// cancel () or after its slot was reused no longer matches and is refused instead
+/// of reaching another timer.  A timer that stops by itself after its last
+/// repetition frees its slot; its handle stays valid, though not running, until the
+/// slot is reused.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_POOL_H
+#define TIMER_POOL_H
+
+#include "Timer.h"
+
+/// Names one timer of a TimerPool.  Generation 0 is never issued, so a handle
+/// with generation 0 names no timer.
+struct timerHandle_t
+{
+	uint8_t index;			///< The slot.
+	uint8_t generation;		///< The slot's generation when the timer was started.
+};
+
+/// What TimerPool.start () needs to start a timer.
+struct timerParams_t
+{
+	timerTime_t period;			///< Ticks between callbacks.
+	uint16_t repeats;			///< Expirations before the timer stops; 0 = never.
+	timerCallBack_t callBack;	///< The function called when the timer expires.
+	void *arg;					///< The argument passed to callBack.
+};
+
+template <uint8_t Slots>
+class TimerPool
+{
+	static_assert (Slots > 0 && Slots < 0xff, "a TimerPool has 1 to 254 slots");
+
+public:
+	/// The constructor leaves every slot free.
+	/**
+		\param timer is the Timer that runs the pool's timers.
+	*/
+	explicit TimerPool (Timer &timer) : _timer (timer)
+	{
+		for (uint8_t i=0; i<Slots; i++)
+		{
+			_slots [i].busy = false;
+			_gen [i] = 0;
+		}
+	}
+
+	/// Start a timer in the first free slot.
+	/**
+		\param p gives the timer's period, repeats, callback and argument.
+		\return the handle of the timer, or a handle of generation 0 if no slot is
+				  free or the Timer is full.
+	*/
+	timerHandle_t start (const timerParams_t &p)
+	{
+		timerHandle_t h = {0, 0};
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		{
+			for (uint8_t i=0; i<Slots; i++)
+			{
+				if (_slots [i].busy)
+					continue;
+
+				timeElement fresh (p.period, p.repeats);
+
+				fresh.setCallBack (Expired, &_slots [i]);
+				_timer.cancelTimer (&_slots [i].timer);	// Drop expirations left for dispatch ().
+				_slots [i].timer = fresh;
+				_slots [i].callBack = p.callBack;
+				_slots [i].arg = p.arg;
+				Advance (i);
+				if (_timer.startTimer (&_slots [i].timer))
+				{
+					_slots [i].busy = true;
+					h.index = i;
+					h.generation = _gen [i];
+				}
+				break;
+			}
+		}
+		return h;
+	}
+
+	/// Stop a timer and free its slot.  A stale handle is ignored.
+	/**
+		\param h is the handle returned by start ().
+		\return true if the handle was current.
+	*/
+	bool cancel (const timerHandle_t h)
+	{
+		bool current = false;
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		{
+			if (Current (h))
+			{
+				_timer.cancelTimer (&_slots [h.index].timer);
+				_slots [h.index].busy = false;
+				Advance (h.index);
+				current = true;
+			}
+		}
+		return current;
+	}
+
+	/// Asks whether a handle's timer is still running.
+	/**
+		\param h is the handle returned by start ().
+		\return true if the handle is current and its timer has neither finished nor
+				  been canceled, including while its callback runs.
+	*/
+	bool isRunning (const timerHandle_t h) const
+	{
+		bool running;
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+			running = Current (h) && _slots [h.index].busy;
+		return running;
+	}
+
+	/// Look up the timeElement of a handle, to modify it.
+	/**
+		\param h is the handle returned by start ().
+		\return a pointer to the timeElement, or 0 if the handle is stale.
+	*/
+	timeElement *get (const timerHandle_t h)
+	{
+		timeElement *pTE;
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+			pTE = Current (h) ? &_slots [h.index].timer : 0;
+		return pTE;
+	}
+
+private:
+	/// A timer with the callback the pool calls for it.
+	struct Slot
+	{
+		timeElement timer;			///< The timer itself.
+		timerCallBack_t callBack;	///< The function given to start ().
+		void *arg;					///< The argument given to start ().
+		bool busy;					///< Started, and neither finished nor canceled.
+	};
+
+	/// The callback of every slot's timer:  call the slot's function, and free the
+	/// slot if that was the last repetition.  The Timer counts the repetition after
+	/// the callback returns, or, for a deferred timer, when it expired.
+	/**
+		\param slot is the Slot.
+	*/
+	static void Expired (void *slot)
+	{
+		Slot *s = static_cast<Slot *> (slot);
+
+		s->callBack (s->arg);
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		{
+			uint16_t left = s->timer.getRemaining ();
+#if TIMER_DEFER
+			if (s->timer.isDeferred () && 0 == left)
+				left = 1;		// Counted already; a running one is still queued.
+#endif
+			if (!s->timer.isRunning () && 1 == left)
+				s->busy = false;
+		}
+	}
+
+	/// Asks whether a handle names the present generation of its slot.
+	bool Current (const timerHandle_t h) const
+	{
+		return h.index < Slots && 0 != h.generation && _gen [h.index] == h.generation;
+	}
+
+	/// Move a slot to its next generation, skipping 0.
+	void Advance (const uint8_t i)
+	{
+		if (0 == ++_gen [i])
+			_gen [i] = 1;
+	}
+
+	Timer &_timer;				///< Runs the pool's timers.
+	Slot _slots [Slots];		///< The timers and their callbacks.
+	uint8_t _gen [Slots];		///< The generation of each slot.
+};
+
+#endif // TIMER_POOL_H
@@ -0,0 +1,214 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerQueue.cpp - Source file for the sorted, intrusive timer queue.
+///
+/// See TimerQueue.h.  The queue is only compiled when TIMER_ENGINE selects it.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "Timer.h"
+
+#if TIMER_ENGINE == TIMER_ENGINE_LIST
+
+/// Walk past every timer due no later than pTE and link pTE in front of the next.
+/**
+	\param pTE points to a timeElement that is not already in the queue.
+*/
+void TimerQueue::Insert (const p_timeElement pTE)
+{
+	p_timeElement *pprev = &_head;
+
+	while (*pprev && !timerBefore (pTE->_timeOut, (*pprev)->_timeOut))
+		pprev = &(*pprev)->_next;
+
+	pTE->linkAt (pprev);
+	_count++;
+}
+
+/// Unlink a timer from the queue.  Timers not in the queue are ignored.
+/**
+	\param pTE points to the timeElement to be removed.
+*/
+void TimerQueue::Remove (const p_timeElement pTE)
+{
+	if (!Contains (pTE))
+		return;
+
+	pTE->unlink ();
+	_count--;
+}
+
+/// Walk past the timers due by now and move that run, in order, from the head of
+/// the queue to the due list.
+/**
+	\param now is the present time.
+*/
+void TimerQueue::Expire (const timerTime_t now)
+{
+	p_timeElement *pprev = &_head;
+
+	while (*pprev && !timerBefore (now, (*pprev)->_timeOut))
+		pprev = &(*pprev)->_next;
+	if (pprev == &_head)
+		return;
+
+	p_timeElement rest = *pprev;
+
+	*pprev = _due;				// The run goes in front of any timers not yet popped.
+	if (_due)
+		_due->_pprev = pprev;
+	_due = _head;
+	_due->_pprev = &_due;
+	_head = rest;
+	if (rest)
+		rest->_pprev = &_head;
+}
+
+/// Take the first timer of the due list.
+/**
+	\return a pointer to the unlinked timeElement, or 0 if none is left.
+*/
+p_timeElement TimerQueue::Pop ()
+{
+	p_timeElement pTE = _due;
+
+	if (pTE)
+	{
+		pTE->unlink ();
+		_count--;
+	}
+	return pTE;
+}
+
+/// Link a timer onto the front of the held list.
+/**
+	\param pTE points to a timeElement that is not in the queue.
+*/
+void TimerQueue::Hold (const p_timeElement pTE)
+{
+	pTE->linkAt (&_held);
+	_count++;
+}
+
+/// Sort the held timers and merge them into the queue.  The held list is in the
+/// reverse order of Hold (), so it is reversed first; the sort is stable and a held
+/// timer goes behind queued timers with the same timeOut, so equal timeOuts keep
+/// expiring in the order they were inserted.
+/**
+	\param now is the present time.
+	\return true if the head of the queue is due by now again.
+*/
+bool TimerQueue::Merge (const timerTime_t now)
+{
+	p_timeElement list = 0, pTE = _held;
+
+	while (pTE)
+	{
+		p_timeElement next = pTE->_next;
+
+		pTE->_next = list;
+		list = pTE;
+		pTE = next;
+	}
+	_held = 0;
+	list = Sort (list);
+
+	p_timeElement *pprev = &_head;
+
+	while (list)				// Each pass resumes where the last timer went in.
+	{
+		pTE = list;
+		list = list->_next;
+		while (*pprev && !timerBefore (pTE->_timeOut, (*pprev)->_timeOut))
+			pprev = &(*pprev)->_next;
+		pTE->linkAt (pprev);
+		pprev = &pTE->_next;
+	}
+	return _head && !timerBefore (now, _head->_timeOut);
+}
+
+/// Sort a chain of timers linked through _next by timeOut, keeping the order of
+/// equal timeOuts.  Only _next is maintained; Merge () relinks the timers.
+/**
+	\param list is the first timer of the chain, or 0.
+	\return the first timer of the sorted chain.
+*/
+p_timeElement TimerQueue::Sort (p_timeElement list)
+{
+	if (0 == list || 0 == list->_next)
+		return list;
+
+	p_timeElement slow = list, fast = list->_next;
+
+	while (fast && fast->_next)	// Split the chain in the middle.
+	{
+		slow = slow->_next;
+		fast = fast->_next->_next;
+	}
+	p_timeElement second = Sort (slow->_next);
+
+	slow->_next = 0;
+	list = Sort (list);
+
+	p_timeElement head, *tail = &head;
+
+	while (list && second)		// Ties are taken from the first half.
+	{
+		p_timeElement *pick = timerBefore (second->_timeOut, list->_timeOut) ? &second : &list;
+
+		*tail = *pick;
+		tail = &(*pick)->_next;
+		*pick = *tail;
+	}
+	*tail = list ? list : second;
+	return head;
+}
+
+/// Walk the queue from its head to the first timer due no earlier than lo.  The
+/// queue is sorted, so that is the earliest candidate; timers held by Expire () are
+/// checked one by one.
+/**
+	\param lo is the start of the window.
+	\param hi is the end of the window, inclusive.
+	\param t receives the timeOut found.
+	\return true if a timer is due within the window.
+*/
+bool TimerQueue::Find (const timerTime_t lo, const timerTime_t hi, timerTime_t &t) const
+{
+	p_timeElement pTE = _head;
+	bool found = false;
+
+	while (pTE && timerBefore (pTE->_timeOut, lo))
+		pTE = pTE->_next;
+	if (pTE && !timerBefore (hi, pTE->_timeOut))
+	{
+		t = pTE->_timeOut;
+		found = true;
+	}
+	for (pTE = _held; pTE; pTE = pTE->_next)	// Unsorted; held during Expire () only.
+		if (!timerBefore (pTE->_timeOut, lo) && !timerBefore (hi, pTE->_timeOut)
+			&& (!found || timerBefore (pTE->_timeOut, t)))
+		{
+			t = pTE->_timeOut;
+			found = true;
+		}
+	return found;
+}
+
+/// Asks whether a timer is linked into the queue.
+/**
+	\param pTE points to the timeElement in question.
+	\return true if pTE is in the queue.
+*/
+bool TimerQueue::Contains (const p_timeElement pTE)
+{
+	return 0 != pTE->_pprev;
+}
+
+#endif // TIMER_ENGINE_LIST
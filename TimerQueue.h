@@ -0,0 +1,125 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerQueue.h - Header file for the sorted, intrusive timer queue.
+///
+/// The queue is behind Timer when TIMER_ENGINE is TIMER_ENGINE_LIST.  The running
+/// timers form one doubly linked list, sorted by timeOut, that is threaded through
+/// the timeElements themselves.  The caller owns every timeElement, so the queue
+/// needs no storage of its own and holds any number of timers.
+///
+///		Insert		O(n)	walk to the first later timeOut and link in front of it,
+///		Remove		O(1)	unlink,
+///		Expire		O(k)	detach the k timers due from the head of the queue,
+///		Pop			O(1)	take the next detached timer,
+///		Hold		O(1)	set aside a timer that has run or is starting, to be merged
+///							later,
+///		Merge		O(k log k + n)	sort the held timers and merge them into the
+///							queue in one pass.
+///
+/// A tick that expires k timers therefore costs O(k log k + n), not the O(k * n) of
+/// re-inserting each one as it runs.  Detached and held timers stay linked (into the
+/// due and held lists), so Contains () and Remove () work on them as on any other,
+/// and a callback can cancel or restart a timer still waiting its turn.
+///
+/// Timers with equal timeOuts expire in the order they were inserted.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_QUEUE_H
+#define TIMER_QUEUE_H
+
+#include <inttypes.h>
+
+class timeElement;
+typedef timeElement *p_timeElement;
+typedef uint32_t timerTime_t;
+
+class TimerQueue
+{
+public:
+	/// Constructor empties the queue.
+	TimerQueue () : _head (0), _due (0), _held (0), _count (0) {}
+
+	/// Link a timer into the queue in timeOut order.
+	/**
+		\param pTE points to a timeElement that is not already in the queue.
+	*/
+	void Insert (const p_timeElement pTE);
+
+	/// Unlink a timer.  Timers not in the queue are ignored.
+	/**
+		\param pTE points to the timeElement to be removed.
+	*/
+	void Remove (const p_timeElement pTE);
+
+	/// Detach every timer due by now from the head of the queue, for Pop ().
+	/**
+		\param now is the present time.
+	*/
+	void Expire (const timerTime_t now);
+
+	/// Take the next timer detached by Expire ().
+	/**
+		\return a pointer to the unlinked timeElement, or 0 if none is left.
+	*/
+	p_timeElement Pop ();
+
+	/// Set aside a popped or newly started timer until Merge ().  It counts as
+	/// queued meanwhile.
+	/**
+		\param pTE points to a timeElement whose timeOut has been updated.
+	*/
+	void Hold (const p_timeElement pTE);
+
+	/// Link the held timers into the queue in timeOut order.
+	/**
+		\param now is the present time.
+		\return true if the head of the queue is due by now again.
+	*/
+	bool Merge (const timerTime_t now);
+
+	/// Request the timer that expires first.
+	/**
+		\return a pointer to the head of the queue, or 0 if the queue is empty.
+	*/
+	p_timeElement Head () const {return _head;}
+
+	/// Find the earliest timeOut of a queued timer within a window.  Used to
+	/// coalesce timers that have slack (TIMER_SLACK).
+	/**
+		\param lo is the start of the window.
+		\param hi is the end of the window, inclusive.
+		\param t receives the timeOut found.
+		\return true if a timer is due within the window.
+	*/
+	bool Find (const timerTime_t lo, const timerTime_t hi, timerTime_t &t) const;
+
+	/// Asks whether a timer is linked into the queue.
+	/**
+		\param pTE points to the timeElement in question.
+		\return true if pTE is in the queue.
+	*/
+	static bool Contains (const p_timeElement pTE);
+
+	/// Retrieve the number of timers in the queue.
+	/**
+		\return the number of timers linked into the queue.
+	*/
+	uint16_t GetCount () const {return _count;}
+
+private:
+	static p_timeElement Sort (p_timeElement list);	///< Stable merge sort of a _next chain.
+
+	p_timeElement _head;	///< The timer with the earliest timeOut.
+	p_timeElement _due;		///< Timers detached by Expire () and not yet popped.
+	p_timeElement _held;	///< Timers waiting for Merge (), latest held first.
+	uint16_t _count;		///< Number of timers in the queue.
+};
+
+#endif // TIMER_QUEUE_H
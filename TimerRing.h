@@ -0,0 +1,91 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerRing.h - A single-producer, single-consumer ring buffer.
+///
+/// Usage:  1  Instantiate a TimerRing<T, N> where N is a power of two no larger
+///            than 128.
+///         2  One context (normally an ISR) calls Push (); one other context
+///            (normally loop ()) calls Pop ().  Neither needs to disable interrupts:
+///            each index is a single byte written by only one side, and an element
+///            is stored before the head index that publishes it.
+///         3  Push () returns false when the ring is full and the element is not
+///            stored.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_RING_H
+#define TIMER_RING_H
+
+#include <inttypes.h>
+
+/// Keep the compiler from moving memory accesses across this point.
+#define TIMER_BARRIER()	__asm__ __volatile__ ("" ::: "memory")
+
+template <typename T, uint8_t N>
+class TimerRing
+{
+	static_assert (N > 0 && N <= 128 && 0 == (N & (N - 1)), "TimerRing size must be a power of two up to 128");
+
+public:
+	/// Constructor empties the ring.
+	TimerRing () : _head (0), _tail (0) {}
+
+	/// Store an element at the head of the ring.  Producer side only.
+	/**
+		\param v is the element to be stored.
+		\return true if stored or false if the ring is full.
+	*/
+	bool Push (const T &v)
+	{
+		uint8_t head = _head;
+
+		if ((uint8_t) (head - _tail) == N)
+			return false;
+		_buf [head & (N - 1)] = v;
+		TIMER_BARRIER ();		// The element is in place before it is published.
+		_head = head + 1;
+		return true;
+	}
+
+	/// Take the element at the tail of the ring.  Consumer side only.
+	/**
+		\param v receives the element.
+		\return true if an element was taken or false if the ring is empty.
+	*/
+	bool Pop (T &v)
+	{
+		uint8_t tail = _tail;
+
+		if (tail == _head)
+			return false;
+		v = _buf [tail & (N - 1)];
+		TIMER_BARRIER ();		// The element is read before its slot is released.
+		_tail = tail + 1;
+		return true;
+	}
+
+	/// Request the number of elements in the ring.
+	/**
+		\return the number of elements pushed and not yet popped.
+	*/
+	uint8_t GetCount () const {return _head - _tail;}
+
+	/// Asks whether the ring is full.
+	/**
+		\return true if Push () would fail.
+	*/
+	bool isFull () const {return GetCount () == N;}
+
+private:
+	T _buf [N];
+	volatile uint8_t _head;	///< Next slot to fill; written by the producer only.
+	volatile uint8_t _tail;	///< Next slot to empty; written by the consumer only.
+};
+
+#endif // TIMER_RING_H
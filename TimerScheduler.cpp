@@ -0,0 +1,198 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerScheduler.cpp - Cooperative, run-to-completion tasks released by a Timer.
+/// See TimerScheduler.h for usage.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "TimerScheduler.h"
+
+/// Start a task, or restart it from now.  A job waiting from an earlier start is
+/// dropped; one that is running completes.
+/**
+	\param t is the task; it must outlive its run.
+	\return false if the Timer had no room for the task's timer.
+*/
+bool TimerScheduler::start (timerTask &t)
+{
+	cancel (t);
+	t._scheduler = this;
+	t._timer.setCallBack (Release, &t);
+	return _timer.startTimer (&t._timer);
+}
+
+/// Stop a task.  A job waiting to run is dropped; one that is running completes.
+/**
+	\param t is the task.
+*/
+void TimerScheduler::cancel (timerTask &t)
+{
+	ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+	{
+		_timer.cancelTimer (&t._timer);
+		if (timerTask::RELEASED == t._state)
+		{
+			Unlink (&_released, &t);
+			if (0 == _released)
+				_last = &_released;
+			else if (0 == t._next)	// It was the last; find the new one.
+			{
+				timerTask *p = _released;
+
+				while (p->_next)
+					p = p->_next;
+				_last = &p->_next;
+			}
+		}
+		else if (timerTask::READY == t._state)
+			Unlink (&_ready, &t);
+		if (timerTask::RUNNING != t._state)
+			t._state = timerTask::IDLE;
+	}
+}
+
+/// Call from loop () to run the jobs released so far, one at a time and to
+/// completion, in the order the policy gives.  Releases that arrive meanwhile are
+/// ranked before the next job is chosen.  Returns once no job is left.
+/**
+	\return the number of jobs run.
+*/
+uint16_t TimerScheduler::run ()
+{
+	uint16_t jobs = 0;
+
+	for (;;)
+	{
+		timerTask *t;
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		{
+			t = _released;
+			_released = 0;
+			_last = &_released;
+			for (timerTask *p = t; p; p = p->_next)
+				p->_state = timerTask::READY;
+		}
+		while (t)
+		{
+			timerTask *next = t->_next;
+
+			Enqueue (t);
+			t = next;
+		}
+
+		if (0 == (t = _ready))
+			return jobs;
+		_ready = t->_next;
+
+		timerTime_t release, due;
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		{
+			t->_state = timerTask::RUNNING;
+			release = t->_release;
+			due = t->_due;
+		}
+		t->_job (t->_arg);
+		jobs++;
+
+		timerTime_t now = _timer.getPresentTime ();
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		{
+			if (timerTask::RUNNING == t->_state)
+				t->_state = timerTask::IDLE;	// Otherwise it was released meanwhile.
+			t->_runs++;
+			if (timerBefore (due, now))
+				t->_misses++;
+			if (now - release > t->_worst)
+				t->_worst = now - release;
+		}
+	}
+}
+
+/// Sleep until an interrupt unless a task has been released, so that a release
+/// between run () returning and this call is not slept through.  Idle mode keeps
+/// every timer and peripheral running.  Interrupts are enabled on return.
+void TimerScheduler::idle ()
+{
+	set_sleep_mode (SLEEP_MODE_IDLE);
+	cli ();
+	if (0 == _released)
+	{
+		sleep_enable ();
+		sei ();				// sleep_cpu () executes before any interrupt is taken.
+		sleep_cpu ();
+		sleep_disable ();
+	}
+	sei ();
+}
+
+/// The callback of every task's timer:  record the release and its deadline and
+/// append the task to the released list.  The release is the tick at which the
+/// timer was due, however late it fired and wherever its overrun policy moved its
+/// next timeOut.  A task whose previous job has not started misses a deadline
+/// instead.  Runs in the ISR.
+/**
+	\param task is the timerTask.
+*/
+void TimerScheduler::Release (void *task)
+{
+	timerTask *t = (timerTask *) task;
+	TimerScheduler *s = t->_scheduler;
+
+	if (timerTask::RELEASED == t->_state || timerTask::READY == t->_state)
+	{
+		t->_misses++;
+		return;
+	}
+
+	timerTime_t period = t->_timer.getTimePeriod ();
+
+	t->_release = s->_timer.getDueTime ();	// The timeOut has moved on already, by the overrun policy.
+	t->_due = t->_release + (t->_deadline ? t->_deadline : period);
+	t->_state = timerTask::RELEASED;
+	t->_next = 0;
+	*s->_last = t;
+	s->_last = &t->_next;
+}
+
+/// Insert a task into the ready queue behind every task of the same or higher
+/// urgency, so that ties run in the order they were released.
+/**
+	\param t is a task taken from the released list.
+*/
+void TimerScheduler::Enqueue (timerTask *t)
+{
+	timerTask **p = &_ready;
+
+	if (TIMER_EDF == _policy)
+		while (*p && !timerBefore (t->_due, (*p)->_due))
+			p = &(*p)->_next;
+	else
+		while (*p && (*p)->_priority <= t->_priority)
+			p = &(*p)->_next;
+	t->_next = *p;
+	*p = t;
+}
+
+/// Take a task out of a singly linked list, if it is there.
+/**
+	\param list is the head of the list.
+	\param t is the task.
+*/
+void TimerScheduler::Unlink (timerTask **list, timerTask *t)
+{
+	for (timerTask **p = list; *p; p = &(*p)->_next)
+		if (*p == t)
+		{
+			*p = t->_next;
+			return;
+		}
+}
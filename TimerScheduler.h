@@ -0,0 +1,210 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerScheduler.h - Cooperative, run-to-completion tasks released by a Timer.
+///
+/// Usage:  1  Define each task with its job, the job's argument, its period in ticks
+///            and its number of releases (0 = forever, 1 = one shot):
+///
+///					void sample (void *);
+///					timerTask sampler (sample, 0, 625);
+///
+///         2  Give it a priority (TIMER_PRIORITY:  0 is the most urgent) or a
+///				relative deadline (TIMER_EDF:  by default its period) and start it
+///				on a TimerScheduler defined at file scope:
+///
+///					TimerScheduler tasks (timer, TIMER_EDF);
+///					...
+///					sampler.setDeadline (200);
+///					tasks.start (sampler);
+///
+///         3  Run the jobs from loop ().  run () returns once no job is ready and
+///				idle () sleeps until an interrupt might have released another:
+///
+///					void loop () {tasks.run (); tasks.idle ();}
+///
+/// The Timer's ISR only releases a task:  it notes the release and the absolute
+/// deadline and appends the task to a list, in constant time however many tasks
+/// there are.  run () moves the releases into its ready queue, ordered by absolute
+/// deadline (TIMER_EDF) or by priority (TIMER_PRIORITY), releases of equal rank in
+/// the order they came, and calls the job at its head with interrupts enabled.
+/// Jobs run to completion and never preempt one another, so they share data
+/// without locks.  Periods, deadlines and response times are in ticks.
+///
+/// A job misses its deadline if it completes after the deadline, or if its task
+/// is released again before the job has started; that release is dropped.
+/// getMisses () counts both.  A relative deadline longer than the period therefore
+/// counts misses it need not.  getRuns () counts the jobs completed and getWorst ()
+/// gives the longest response, from release to completion.  Jobs released faster
+/// than they complete keep run () from returning.
+///
+/// Start, cancel and run tasks from loop () or from a job, not from a timer's
+/// callback.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_SCHEDULER_H
+#define TIMER_SCHEDULER_H
+
+#include "Timer.h"
+
+/// How a TimerScheduler orders the jobs that are ready.
+enum timerPolicy_t : uint8_t
+{
+	TIMER_EDF,			///< Earliest absolute deadline first.
+	TIMER_PRIORITY		///< Lowest priority number first.
+};
+
+class TimerScheduler;
+
+/// A job that a Timer releases periodically, or once, into a TimerScheduler.
+class timerTask
+{
+friend class TimerScheduler;	///< The scheduler queues the tasks and keeps their statistics.
+
+public:
+	/// Constructs a task that is not started.
+	/**
+		\param job is called, with interrupts enabled, each time the task runs.
+		\param arg is passed to job.
+		\param period is the number of ticks between releases.
+		\param repeats is the number of releases before the task stops; 0 means
+				 never stop.
+	*/
+	timerTask (timerCallBack_t job, void *arg, timerTime_t period, uint16_t repeats = 0)
+		: _timer (period, repeats), _job (job), _arg (arg), _next (0), _deadline (0),
+		  _state (IDLE), _priority (0), _runs (0), _misses (0), _worst (0) {}
+
+	/// Set the rank of the task under TIMER_PRIORITY.
+	/**
+		\param p is the priority; 0 is the most urgent.
+	*/
+	void setPriority (uint8_t p) {_priority = p;}
+
+	/// Set the time each job has to complete, measured from its release.  Takes
+	/// effect at the next release.
+	/**
+		\param d is the relative deadline in ticks; 0 means the period.
+	*/
+	void setDeadline (timerTime_t d)
+	{
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+			_deadline = d;
+	}
+
+	/// Request the number of jobs that completed.
+	/**
+		\return the runs since the last resetStats (), modulo 0x10000.
+	*/
+	uint16_t getRuns () const
+	{
+		uint16_t n;
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+			n = _runs;
+		return n;
+	}
+
+	/// Request the number of deadlines missed, by jobs that completed late and by
+	/// releases dropped because the previous job had not started.
+	/**
+		\return the misses since the last resetStats (), modulo 0x10000.
+	*/
+	uint16_t getMisses () const
+	{
+		uint16_t n;
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+			n = _misses;
+		return n;
+	}
+
+	/// Request the longest response, from a release to the completion of its job.
+	/**
+		\return the worst response in ticks.
+	*/
+	timerTime_t getWorst () const
+	{
+		timerTime_t t;
+
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+			t = _worst;
+		return t;
+	}
+
+	/// Forget the runs, misses and worst response.
+	void resetStats ()
+	{
+		ATOMIC_BLOCK (ATOMIC_RESTORESTATE)
+		{
+			_runs = 0;
+			_misses = 0;
+			_worst = 0;
+		}
+	}
+
+	/// Request the timer that releases the task, for its modifyXxxx () functions.
+	/**
+		\return the task's timeElement.
+	*/
+	timeElement &getTimer () {return _timer;}
+
+private:
+	enum {IDLE, RELEASED, READY, RUNNING};	///< Values of _state.
+
+	timeElement _timer;		///< Releases the task.
+	timerCallBack_t _job;	///< The work of the task.
+	void *_arg;				///< The argument of _job.
+	TimerScheduler *_scheduler;	///< The scheduler that started the task.
+	timerTask *_next;		///< The next task released or ready.
+	timerTime_t _deadline;	///< Ticks from a release to its deadline; 0 = the period.
+	timerTime_t _release;	///< The tick of the waiting job's release.
+	timerTime_t _due;		///< The waiting job's absolute deadline.
+	volatile uint8_t _state;	///< IDLE, RELEASED, READY or RUNNING.
+	uint8_t _priority;		///< Rank under TIMER_PRIORITY; 0 is the most urgent.
+	uint16_t _runs;			///< Jobs completed.
+	uint16_t _misses;		///< Deadlines missed.
+	timerTime_t _worst;		///< The longest response.
+};
+
+class TimerScheduler
+{
+public:
+	/// The constructor leaves the queues empty.
+	/**
+		\param timer is the Timer that releases the tasks.
+		\param policy orders the ready jobs.
+	*/
+	TimerScheduler (Timer &timer, timerPolicy_t policy = TIMER_EDF)
+		: _timer (timer), _released (0), _last (&_released), _ready (0), _policy (policy) {}
+
+	/// Start a task; its first release comes one period from now.
+	bool start (timerTask &t);
+
+	/// Stop a task and drop its job if one is waiting.
+	void cancel (timerTask &t);
+
+	/// Run the ready jobs, most urgent first, until none is left.
+	uint16_t run ();
+
+	/// Sleep until an interrupt, unless a task has been released already.
+	void idle ();
+
+private:
+	static void Release (void *task);	///< The callback of every task's timer.
+	void Enqueue (timerTask *t);		///< Put a released task in the ready queue.
+	static void Unlink (timerTask **list, timerTask *t);	///< Take a task out of a list.
+
+	Timer &_timer;			///< Releases the tasks.
+	timerTask *_released;	///< Tasks released by the ISR, oldest first.
+	timerTask **_last;		///< The link at the end of _released.
+	timerTask *_ready;		///< Ready tasks, most urgent first; owned by run ().
+	timerPolicy_t _policy;	///< How _ready is ordered.
+};
+
+#endif // TIMER_SCHEDULER_H
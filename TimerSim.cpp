@@ -0,0 +1,294 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerSim.cpp - Virtual Timer/Counters for host (non-AVR) builds.
+///
+/// Nothing in this file is compiled for the AVR.  See TimerSim.h for usage.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#if !defined (__AVR__)
+
+#include "TimerSim.h"
+
+volatile uint8_t SREG = 1 << SREG_I;
+volatile uint8_t TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+volatile uint16_t TCNT1, OCR1A, OCR1B;
+volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2;
+SimFlags TIFR0, TIFR1, TIFR2;
+volatile uint8_t SMCR, ASSR;
+SimGtccr GTCCR;
+
+// Weak references let a host program link without defining every vector.
+extern "C" void TIMER2_COMPA_vect (void) __attribute__ ((weak));
+extern "C" void TIMER2_COMPB_vect (void) __attribute__ ((weak));
+extern "C" void TIMER2_OVF_vect (void) __attribute__ ((weak));
+extern "C" void TIMER1_COMPA_vect (void) __attribute__ ((weak));
+extern "C" void TIMER1_COMPB_vect (void) __attribute__ ((weak));
+extern "C" void TIMER1_OVF_vect (void) __attribute__ ((weak));
+extern "C" void TIMER0_COMPA_vect (void) __attribute__ ((weak));
+extern "C" void TIMER0_COMPB_vect (void) __attribute__ ((weak));
+extern "C" void TIMER0_OVF_vect (void) __attribute__ ((weak));
+
+typedef void (*simVector_t)(void);
+
+/// One virtual Timer/Counter in normal or CTC mode.  The flag bits are the same for
+/// every counter (TOV = 0, OCFA = 1, OCFB = 2) and so are the enable bits in TIMSKn.
+template <typename reg_t>
+struct SimCounter
+{
+	volatile uint8_t &tccrb, &timsk;
+	SimFlags &tifr;
+	volatile reg_t &tcnt, &ocra, &ocrb;
+	const uint16_t *prescalers;	///< Clock divisors indexed by the CS bits; 0 = stopped.
+	volatile uint8_t &wgm;			///< The register holding the CTC mode bit.
+	uint8_t wgmMask, ctcBits;		///< The waveform generation bits in wgm and their CTC value.
+	simVector_t vector [3];		///< Indexed by the interrupt flag bit.
+	uint16_t residue;				///< CPU cycles accumulated toward the next count.
+
+	bool ctc () const {return ctcBits == (wgm & wgmMask) && tcnt <= ocra;}
+	uint32_t cyclesToEvent () const;
+	void count (uint32_t cycles);
+	bool service ();
+};
+
+static const uint16_t tc1Prescalers [8] = {0, 1, 8, 64, 256, 1024, 0, 0};	// Also Timer/Counter 0.
+static const uint16_t tc2Prescalers [8] = {0, 1, 8, 32, 64, 128, 256, 1024};
+
+static SimCounter<uint8_t> tc0 = {TCCR0B, TIMSK0, TIFR0, TCNT0, OCR0A, OCR0B, tc1Prescalers,
+	TCCR0A, 0x03, 1 << WGM01, {TIMER0_OVF_vect, TIMER0_COMPA_vect, TIMER0_COMPB_vect}, 0};
+static SimCounter<uint16_t> tc1 = {TCCR1B, TIMSK1, TIFR1, TCNT1, OCR1A, OCR1B, tc1Prescalers,
+	TCCR1B, 0x18, 1 << WGM12, {TIMER1_OVF_vect, TIMER1_COMPA_vect, TIMER1_COMPB_vect}, 0};
+static SimCounter<uint8_t> tc2 = {TCCR2B, TIMSK2, TIFR2, TCNT2, OCR2A, OCR2B, tc2Prescalers,
+	TCCR2A, 0x03, 1 << WGM21, {TIMER2_OVF_vect, TIMER2_COMPA_vect, TIMER2_COMPB_vect}, 0};
+
+static uint64_t simCycles, simSleepCycles;
+static uint32_t simInterrupts;
+
+/// Request the CPU cycles until the counter next matches a compare register or
+/// overflows.  A match at the present count has already happened.  In CTC mode the
+/// counter returns to 0 after matching compare register A, so it never overflows.
+/**
+	\return the number of cycles, or 0xFFFFFFFF if the counter is stopped.
+*/
+template <typename reg_t>
+uint32_t SimCounter<reg_t>::cyclesToEvent () const
+{
+	uint16_t p = prescalers [tccrb & 0x07];
+
+	if (0 == p) return 0xFFFFFFFF;
+
+	uint32_t toOvf = (uint32_t) (reg_t) ~tcnt + 1;
+	uint32_t toA = (reg_t) (ocra - tcnt), toB = (reg_t) (ocrb - tcnt);
+
+	if (ctc ())
+	{
+		uint32_t toZero = (uint32_t) (ocra - tcnt) + 1;
+
+		toOvf = toA ? toA : toZero + ocra;	// Sitting on the match means a full period.
+		toB = ocrb > ocra ? 0 : ocrb > tcnt ? ocrb - tcnt : toZero + ocrb;
+	}
+
+	uint32_t step = toOvf;
+
+	if (toA && toA < step) step = toA;
+	if (toB && toB < step) step = toB;
+	return step * p - residue;
+}
+
+/// Advance the counter by the counts the prescaler lets through and raise the
+/// flags of the compare match or overflow reached.  Never called with more cycles
+/// than cyclesToEvent ().
+/**
+	\param cycles is the number of CPU clock cycles to count.
+*/
+template <typename reg_t>
+void SimCounter<reg_t>::count (uint32_t cycles)
+{
+	uint16_t p = prescalers [tccrb & 0x07];
+
+	if (0 == p) return;		// Counter stopped.
+
+	uint32_t counts = (residue + cycles) / p;
+	residue = (residue + cycles) % p;
+	if (0 == counts) return;
+
+	reg_t before = tcnt;
+
+	if (ctc ())
+	{
+		uint32_t position = (uint32_t) before + counts;
+
+		tcnt = position > ocra ? position - ocra - 1 : position;
+		if (tcnt == ocra) tifr.raise (1 << 1);
+		if (tcnt == ocrb) tifr.raise (1 << 2);
+		return;
+	}
+
+	tcnt = tcnt + counts;
+	if (tcnt == ocra) tifr.raise (1 << 1);
+	if (tcnt == ocrb) tifr.raise (1 << 2);
+	if (tcnt < before || (reg_t) (before + counts) == 0) tifr.raise (1 << 0);
+}
+
+/// Call the ISR of the highest priority flag that is pending and enabled.  As on
+/// the part, entering an ISR clears its flag and the I bit, and returning sets the
+/// I bit again.
+/**
+	\return true if an ISR was called.
+*/
+template <typename reg_t>
+bool SimCounter<reg_t>::service ()
+{
+	static const uint8_t order [3] = {1, 2, 0};	// Compare A, compare B, overflow.
+
+	for (uint8_t i=0; i<3; i++)
+	{
+		uint8_t bit = 1 << order [i];
+
+		if ((tifr & bit) && (timsk & bit) && vector [order [i]])
+		{
+			tifr = bit;
+			simInterrupts++;
+			cli ();
+			vector [order [i]] ();
+			sei ();
+			return true;
+		}
+	}
+	return false;
+}
+
+/// Service pending interrupts in vector order (Timer/Counter 2, then 1, then 0) for
+/// as long as the I bit is set.
+static void serviceAll ()
+{
+	while ((SREG & (1 << SREG_I)) && (tc2.service () || tc1.service () || tc0.service ()))
+		;
+}
+
+/// Restart the prescalers named by the bits written.  The counts toward the next
+/// tick of the counters they drive are dropped.
+/**
+	\param bits has PSRASY and PSRSYNC set for the prescalers to restart.
+	\return this register.
+*/
+SimGtccr & SimGtccr::operator= (const uint8_t bits)
+{
+	if (bits & (1 << PSRASY))
+		tc2.residue = 0;
+	if (bits & (1 << PSRSYNC))
+		tc0.residue = tc1.residue = 0;
+	return *this;
+}
+
+/// Stop the counters, clear every register and set the I bit.
+void TimerSim::reset ()
+{
+	// Stored one by one; C++20 deprecates chaining assignments to volatiles.
+	static volatile uint8_t *const bytes [] = {&TCCR0A, &TCCR0B, &TCNT0, &OCR0A, &OCR0B,
+		&TIMSK0, &TIFR0._bits, &TCCR1A, &TCCR1B, &TIMSK1, &TIFR1._bits, &TCCR2A, &TCCR2B,
+		&TCNT2, &OCR2A, &OCR2B, &TIMSK2, &TIFR2._bits, &SMCR, &ASSR};
+	static volatile uint16_t *const words [] = {&TCNT1, &OCR1A, &OCR1B};
+
+	for (volatile uint8_t *r : bytes)
+		*r = 0;
+	for (volatile uint16_t *r : words)
+		*r = 0;
+	tc0.residue = tc1.residue = tc2.residue = 0;
+	simCycles = simSleepCycles = 0;
+	simInterrupts = 0;
+	SREG = 1 << SREG_I;
+}
+
+/// Run every counter to the next event, or by cycles if that comes first, and
+/// service the interrupts raised.
+/**
+	\param cycles is the most CPU clock cycles to run.
+	\return the cycles run.
+*/
+static uint32_t step (uint32_t cycles)
+{
+	uint32_t run = tc0.cyclesToEvent (), step1 = tc1.cyclesToEvent (), step2 = tc2.cyclesToEvent ();
+
+	if (step1 < run) run = step1;
+	if (step2 < run) run = step2;
+	if (cycles < run) run = cycles;
+
+	tc0.count (run);
+	tc1.count (run);
+	tc2.count (run);
+	simCycles += run;
+	serviceAll ();
+	return run;
+}
+
+/// Run the virtual CPU clock forward one event at a time so that the interrupts of
+/// all counters are delivered in time order.  Pending interrupts are serviced first
+/// so that advance (0) after interrupts () delivers whatever coalesced meanwhile.
+/**
+	\param cycles is the number of CPU clock cycles to run.
+*/
+void TimerSim::advance (uint32_t cycles)
+{
+	serviceAll ();
+	while (cycles > 0)
+		cycles -= step (cycles);
+}
+
+/// Sleep until an interrupt is serviced.  A pending interrupt wakes the processor
+/// at once.  With every counter stopped nothing could wake it, so the host returns
+/// rather than hang.
+void TimerSim::sleep ()
+{
+	if (0 == (SMCR & (1 << SE)) || 0 == (SREG & (1 << SREG_I)))
+		return;
+
+	uint32_t before = simInterrupts;
+
+	serviceAll ();
+	while (before == simInterrupts)
+	{
+		uint32_t slept = step (0xFFFFFFFF);
+
+		if (0xFFFFFFFF == slept)
+			return;
+		simSleepCycles += slept;
+	}
+}
+
+/// Request the number of CPU clock cycles simulated since the last reset.
+/**
+	\return the virtual cycle count.
+*/
+uint64_t TimerSim::cycles ()
+{
+	return simCycles;
+}
+
+/// Request the number of ISRs called since the last reset.
+/**
+	\return the interrupt count.
+*/
+uint32_t TimerSim::interruptCount ()
+{
+	return simInterrupts;
+}
+
+/// Request the number of CPU clock cycles spent in sleep_cpu () since the last
+/// reset.
+/**
+	\return the virtual cycles asleep.
+*/
+uint64_t TimerSim::sleepCycles ()
+{
+	return simSleepCycles;
+}
+
+#endif // !__AVR__
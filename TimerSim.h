@@ -0,0 +1,189 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerSim.h - Virtual Timer/Counters for host (non-AVR) builds.
+///
+/// Usage:  1  Build the library sources with a host compiler; TimerHal.h pulls in
+///            this header whenever __AVR__ is not defined.
+///         2  Define the Timer object exactly as a sketch would ("Timer timer;").
+///         3  Call TimerSim::advance (cycles) to run the virtual CPU clock forward.
+///            Timer/Counters 0 and 2 (8-bit) and 1 (16-bit) count through the prescalers
+///            selected in TCCRnB and set TOVn/OCFnA/OCFnB in TIFRn just as the
+///            hardware does.  Pending flags whose interrupts are enabled in TIMSKn
+///            are serviced in vector order by calling the ISR () functions while
+///            the I bit of SREG is set.
+///         4  Clearing the I bit (noInterrupts ()) and then advancing the clock
+///            models a long critical section:  the flags stay pending and the
+///            interrupts coalesce exactly as they would on the part.
+///         5  sleep_cpu () runs the clock forward to the next interrupt when sleep is
+///            enabled and the I bit is set.  TimerSim::sleepCycles () counts the
+///            cycles spent asleep, so the rest of cycles () is the time awake.
+///
+///	Only the normal and clear-timer-on-compare (CTC) counting modes are modeled and
+///	the ISRs themselves take no simulated time.  Every counter keeps running in
+///	every sleep mode; which clocks a mode stops is not modeled.  Fast PWM with TOP = 0xFF, as the
+///	Arduino core sets Timer/Counter 0, raises the same flags as normal mode.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_SIM_H
+#define TIMER_SIM_H
+
+#if !defined (__AVR__)
+
+#include <inttypes.h>
+#include <string.h>
+
+#ifndef F_CPU
+	#define F_CPU 16000000UL	///< The virtual CPU runs at the usual Arduino clock.
+#endif
+
+/// An interrupt flag register.  The simulated hardware sets bits in _bits; the
+/// program reads the register and clears flags by writing ones, as on the part.
+class SimFlags
+{
+public:
+	operator uint8_t () const {return _bits;}
+	SimFlags & operator= (const uint8_t ones) {_bits = (uint8_t) (_bits & ~ones); return *this;}
+	void raise (const uint8_t bits) {_bits = (uint8_t) (_bits | bits);}	///< Set flags, as the counter does.
+
+	volatile uint8_t _bits;
+};
+
+/// The general timer/counter control register.  Writing PSRASY restarts the prescaler
+/// of Timer/Counter 2 and PSRSYNC that of Timer/Counters 0 and 1, as on the part; the
+/// bits read back as 0.
+class SimGtccr
+{
+public:
+	operator uint8_t () const {return 0;}
+	SimGtccr & operator= (const uint8_t bits);
+};
+
+// Status register and the registers of Timer/Counters 0, 1 and 2.
+extern volatile uint8_t SREG;
+extern volatile uint8_t TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+extern volatile uint16_t TCNT1, OCR1A, OCR1B;
+extern volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2;
+extern SimFlags TIFR0, TIFR1, TIFR2;
+extern volatile uint8_t SMCR, ASSR;
+extern SimGtccr GTCCR;
+
+#define SREG_I	7
+#define PSRSYNC	0
+#define PSRASY	1
+#define WGM01	1
+#define WGM12	3
+#define WGM21	1
+#define TOIE0	0
+#define OCIE0A	1
+#define OCIE0B	2
+#define TOV0	0
+#define OCF0A	1
+#define OCF0B	2
+#define TOIE1	0
+#define OCIE1A	1
+#define OCIE1B	2
+#define TOV1	0
+#define OCF1A	1
+#define OCF1B	2
+#define TOIE2	0
+#define OCIE2A	1
+#define OCIE2B	2
+#define TOV2	0
+#define OCF2A	1
+#define OCF2B	2
+#define TCR2BUB	0
+#define TCR2AUB	1
+#define OCR2BUB	2
+#define OCR2AUB	3
+#define TCN2UB	4
+#define AS2		5
+#define SE		0
+#define SM0		1
+#define SM1		2
+#define SM2		3
+
+#define SLEEP_MODE_IDLE		0
+#define SLEEP_MODE_PWR_SAVE	((1 << SM0) | (1 << SM1))
+
+#define cli()				(SREG = (uint8_t) (SREG & ~(1 << SREG_I)))
+#define sei()				(SREG = (uint8_t) (SREG | (1 << SREG_I)))
+#define noInterrupts()	cli ()
+#define interrupts()		sei ()
+
+// The instruction of avr-libc's <avr/cpufunc.h>; the virtual CPU spends a cycle on it.
+#define _NOP()				TimerSim::advance (1)
+
+// Program memory is ordinary memory on the host.
+#define PROGMEM
+#define pgm_read_word(addr)		(*(const uint16_t *) (addr))
+#define pgm_read_dword(addr)	(*(const uint32_t *) (addr))
+#define pgm_read_ptr(addr)		(*(void * const *) (addr))
+
+// The sleep macros of avr-libc's <avr/sleep.h>.
+#define set_sleep_mode(mode)	(SMCR = (uint8_t) ((SMCR & ~((1 << SM0) | (1 << SM1) | (1 << SM2))) | (mode)))
+#define sleep_enable()		(SMCR = (uint8_t) (SMCR | (1 << SE)))
+#define sleep_disable()		(SMCR = (uint8_t) (SMCR & ~(1 << SE)))
+#define sleep_cpu()			TimerSim::sleep ()
+
+// The same construction avr-libc uses in <util/atomic.h>.
+static inline uint8_t __iCliRetVal (void) {cli (); return 1;}
+static inline void __iRestore (const uint8_t *__s) {SREG = *__s;}
+static inline void __iSeiParam (const uint8_t *) {sei ();}
+
+#define ATOMIC_RESTORESTATE	uint8_t sreg_save __attribute__ ((__cleanup__ (__iRestore))) = SREG
+#define ATOMIC_FORCEON			uint8_t sreg_save __attribute__ ((__cleanup__ (__iSeiParam))) = 0
+#define ATOMIC_BLOCK(type)		for (type, __ToDo = __iCliRetVal (); __ToDo; __ToDo = 0)
+
+// Interrupt vectors are plain functions that TimerSim calls.
+#define ISR(vector, ...)	extern "C" void vector (void) __VA_ARGS__; extern "C" void vector (void)
+
+/// TimerSim drives the virtual hardware.  All members are static because there is
+/// exactly one (virtual) microcontroller.
+class TimerSim
+{
+public:
+	/// Stop the counters, clear every register and set the I bit.
+	static void reset ();
+
+	/// Run the virtual CPU clock forward and service any interrupts that fall due.
+	/**
+		\param cycles is the number of CPU clock cycles to run.  Zero only services
+				 interrupts that are already pending.
+	*/
+	static void advance (uint32_t cycles);
+
+	/// Execute the SLEEP instruction:  if sleep is enabled and the I bit is set, run
+	/// the clock until an interrupt has been serviced.
+	static void sleep ();
+
+	/// Request the number of CPU clock cycles simulated since the last reset.
+	/**
+		\return the virtual cycle count.
+	*/
+	static uint64_t cycles ();
+
+	/// Request the number of ISRs called since the last reset.
+	/**
+		\return the interrupt count.
+	*/
+	static uint32_t interruptCount ();
+
+	/// Request the number of CPU clock cycles spent in sleep_cpu () since the last
+	/// reset.
+	/**
+		\return the virtual cycles asleep.
+	*/
+	static uint64_t sleepCycles ();
+};
+
+#endif // !__AVR__
+
+#endif // TIMER_SIM_H
@@ -0,0 +1,70 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerStats.h - Instrumentation records for TIMER_STATS builds.
+///
+/// Usage:  1  Define TIMER_STATS as 1 before Timer.h is included.
+///         2  From loop (), copy the records with timeElement.getStats () and
+///            Timer.getStats ().  Each copy is taken with interrupts disabled, so
+///            its fields agree with one another.
+///         3  Start a new measurement with resetStats ().
+///
+/// Durations and lateness are in counts of the hardware counter that drives the
+/// Timer, that is, in units of the prescaled clock; a tick is countsPerTick counts.
+/// They are measured inside the ISR only, so a deferred timer (TIMER_DEFER) is
+/// charged for being queued, not for its callback.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_STATS_H
+#define TIMER_STATS_H
+
+#include <inttypes.h>
+
+/// What one timer has cost and how late it has run.
+struct timeElementStats_t
+{
+	uint32_t fires;		///< Expirations since the last reset.
+	uint32_t cbTotal;		///< Sum of the callback durations; cbTotal / fires is the mean.
+	uint16_t cbMin;		///< Shortest callback; 0xFFFF until the first expiration.
+	uint16_t cbMax;		///< Longest callback.
+	uint16_t lateMax;		///< Most counts between the timer's tick and its callback.
+
+	/// Forget every measurement.
+	void Reset () {fires = cbTotal = 0; cbMin = 0xFFFF; cbMax = lateMax = 0;}
+
+	/// Account for one expiration.
+	/**
+		\param late is the counts from the timer's tick to the callback.
+		\param cost is the counts the callback took.
+	*/
+	void Record (const uint16_t late, const uint16_t cost)
+	{
+		fires++;
+		cbTotal += cost;
+		if (cost < cbMin) cbMin = cost;
+		if (cost > cbMax) cbMax = cost;
+		if (late > lateMax) lateMax = late;
+	}
+};
+
+/// What the ISR of one Timer has cost.  The ISR's share of the processor is
+/// isrCounts / (ticks * countsPerTick).
+struct timerStats_t
+{
+	uint32_t ticks;			///< Ticks counted since the last reset.
+	uint32_t isrCounts;		///< Counts spent in the ISR.
+	uint16_t countsPerTick;	///< Counts of the hardware counter in one tick.
+	uint16_t maxDepth;		///< Most timers queued at once.
+	uint16_t overruns;		///< ISRs that ended after the next tick had begun.
+
+	/// Forget every measurement.
+	void Reset () {ticks = isrCounts = 0; maxDepth = overruns = 0;}
+};
+
+#endif // TIMER_STATS_H
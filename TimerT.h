@@ -0,0 +1,143 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerT.h - A Timer whose hardware timer, prescaler and capacity are fixed at
+/// compile time.
+///
+/// Usage:  1  Instantiate TimerT<Capacity, HwTimer, Prescaler> at file scope, e.g.
+///
+///					TimerT<8, 1, 64> slowTimer;
+///
+///				Capacity is the number of timers the heap engine can run at once
+///				(the list and wheel engines have no limit and ignore it).  HwTimer is
+///				0, 1 or 2 (see TimerHw.h) and Prescaler is the clock division itself,
+///				not its CS code.  An unsupported division does not compile.
+///				Timer/Counter 0 is shared with millis () and only takes 64.
+///				Each TimerT has its own queue and clock, so a fine-grained TimerT
+///				and a coarse one can run side by side, and beside the global
+///				'timer' as long as they leave it Timer/Counter 2.
+///         2  Bind the hardware timer's interrupt to the object, also at file scope:
+///
+///					TIMER_ISR (1, slowTimer);
+///
+///				TIMER_ISR (2, ...) replaces the default Timer/Counter 2 ISR, which
+///				drives the global 'timer' and is only needed when there is one.
+///				The ISR is the Timer's own, compiled for the counter it reads, so
+///				the hardware is reached without a virtual call or function pointer.
+///         3  Call slowTimer.begin () from setup ().  The Arduino core's init ()
+///				reprograms Timer/Counters 1 and 2 for PWM after file-scope objects
+///				are constructed.
+///         4  Use the object as any Timer.  Periods given as constants convert
+///				to ticks at compile time:
+///
+///					te.setPeriod (slowTimer.ms<250> ());
+///
+///				and ms<> () and us<> () refuse intervals shorter than one tick or
+///				longer than 0x7FFFFFFF ticks.  configTimers is not available; the
+///				prescaler is part of the type.
+///
+/// TimerT cannot be combined with TIMER_TICKLESS, which owns Timer/Counter 1, nor
+/// with TIMER_AUTOSCALE, which chooses the prescaler at run time.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_T_H
+#define TIMER_T_H
+
+#include "Timer.h"
+#include "TimerHw.h"
+
+template <uint16_t Capacity, uint8_t HwTimer = 2, uint16_t Prescaler = 1>
+class TimerT : public Timer
+{
+	static_assert (0 != TimerHw<HwTimer>::cs (Prescaler), "the hardware timer has no such prescaler division");
+	static_assert (Capacity > 0, "a TimerT needs room for at least one timer");
+	static_assert (sizeof (TimerHw<HwTimer>) && !TIMER_TICKLESS, "TimerT cannot be used with TIMER_TICKLESS");
+	static_assert (sizeof (TimerHw<HwTimer>) && !TIMER_AUTOSCALE, "TimerT cannot be used with TIMER_AUTOSCALE");
+
+public:
+	/// The constructor empties the queue and starts the hardware timer.
+	TimerT ()
+#if TIMER_ENGINE == TIMER_ENGINE_HEAP
+		: Timer (_storage, Capacity, TimerHw<HwTimer>::stamp, timerLog2 (Prescaler))
+#else
+		: Timer (0, Capacity, TimerHw<HwTimer>::stamp, timerLog2 (Prescaler))
+#endif
+	{
+		begin ();
+	}
+
+	/// The destructor disables the interrupt.
+	virtual ~TimerT () {TimerHw<HwTimer>::end ();}
+
+	/// Program the hardware timer again, as the constructor did.  Call from setup ().
+	void begin () {TimerHw<HwTimer>::begin (TimerHw<HwTimer>::cs (Prescaler));}
+
+	/// Advance the clock one tick and call back the timers due.  The ISR bound by
+	/// TIMER_ISR calls it.
+	void clockTick () {NextTick<TimerHw<HwTimer> > ();}
+
+	/// The prescaler is fixed by the template argument.
+	void configTimers (const uint8_t prescaler) = delete;
+
+	/// Convert microseconds to ticks of this Timer.
+	/**
+		\param us is the interval in microseconds.
+		\return the nearest whole number of ticks.
+	*/
+	static constexpr timerTime_t usToTicks (const uint32_t us) {return timerUsToTicks (us, Prescaler);}
+
+	/// Convert milliseconds to ticks of this Timer.
+	/**
+		\param ms is the interval in milliseconds.
+		\return the nearest whole number of ticks.
+	*/
+	static constexpr timerTime_t msToTicks (const uint32_t ms) {return timerMsToTicks (ms, Prescaler);}
+
+	/// Convert a constant number of microseconds to ticks, checked at compile time.
+	/**
+		\return the nearest whole number of ticks.
+	*/
+	template <uint32_t Us>
+	static constexpr timerTime_t us ()
+	{
+		static_assert (timerUsToTicks (Us, Prescaler) >= 1, "the period is shorter than one tick");
+		static_assert (timerUsToTicks (Us, Prescaler) <= 0x7FFFFFFF, "the period is too long for the clock");
+		return timerUsToTicks (Us, Prescaler);
+	}
+
+	/// Convert a constant number of milliseconds to ticks, checked at compile time.
+	/**
+		\return the nearest whole number of ticks.
+	*/
+	template <uint32_t Ms>
+	static constexpr timerTime_t ms ()
+	{
+		static_assert (timerMsToTicks (Ms, Prescaler) >= 1, "the period is shorter than one tick");
+		static_assert (timerMsToTicks (Ms, Prescaler) <= 0x7FFFFFFF, "the period is too long for the clock");
+		return timerMsToTicks (Ms, Prescaler);
+	}
+
+protected:
+	/// Name the deepest sleep mode that keeps this TimerT's counter running.
+	virtual uint8_t SleepMode () const {return TimerHw<HwTimer>::sleepMode ();}
+
+private:
+#if TIMER_BOUNDED
+	p_timeElement _storage [Capacity];	///< The heap of running timers.
+#endif
+};
+
+/// Bind the interrupt of Timer/Counter n to the clock of a TimerT.
+#define TIMER_ISR(n, obj)	TIMER_ISR_N (n, obj)
+#define TIMER_ISR_N(n, obj)	TIMER_ISR_##n (obj)	///< Expands n first, should it be a macro.
+#define TIMER_ISR_0(obj)	ISR (TIMER0_COMPA_vect) {(obj).clockTick ();}
+#define TIMER_ISR_1(obj)	ISR (TIMER1_COMPA_vect) {(obj).clockTick ();}
+#define TIMER_ISR_2(obj)	ISR (TIMER2_OVF_vect) {(obj).clockTick ();}
+
+#endif // TIMER_T_H
@@ -0,0 +1,143 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerTrace.h - Event recorder for TIMER_TRACE builds.
+///
+/// Usage:  1  Define TIMER_TRACE as 1 before Timer.h is included.  The Timer then
+///            keeps its last TIMER_TRACE_SIZE events, 8 bytes each.
+///         2  From loop (), write them out with timer.dumpTrace (Serial), or to
+///            any object with a write (const uint8_t *, size_t) member.  Each dump
+///            empties the recorder; recording goes on meanwhile.
+///         3  Decode the captured bytes on the host with extras/trace.
+///
+/// Every event is stamped with the low 16 bits of presentTime and the counts of the
+/// hardware counter since that tick began, so timelines resolve single counts of
+/// the prescaled clock.  Events are recorded with interrupts already disabled, by
+/// the ISR or inside the critical sections of startTimer () and cancelTimer ().
+/// Recording costs a counter read and an 8-byte store.  When the recorder is full
+/// the oldest event is dropped, unless a dump is writing it out, in which case the
+/// new event is dropped instead.  So a dump holds exactly the events its header
+/// counts, in an unbroken run, and the next dump reports how many were dropped.
+///
+/// A dump is a 10-byte header followed by its records, all little-endian:
+///
+///		'T' 'T'			magic
+///		version			TIMER_TRACE_VERSION
+///		record size		8
+///		countsPerTick	uint16_t
+///		dropped			uint16_t, events lost since the last dump
+///		count			uint16_t, records that follow
+///
+/// and each record is a timerTraceEvent_t.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_TRACE_H
+#define TIMER_TRACE_H
+
+#include <inttypes.h>
+
+#define TIMER_TRACE_VERSION 1	///< The dump format written by Timer.dumpTrace ().
+
+/// What a trace record describes.
+enum timerTraceKind_t
+{
+	TIMER_TRACE_START = 1,	///< A timer was started or restarted.
+	TIMER_TRACE_CANCEL,		///< A timer was canceled.
+	TIMER_TRACE_FIRE,		///< A timer's callback is about to run; data = ticks late.
+	TIMER_TRACE_END,		///< The callback returned; data = 1 if the timer goes on.
+	TIMER_TRACE_LOST		///< The ISR ran into the next tick; timer = 0.
+};
+
+/// One recorded event.
+struct timerTraceEvent_t
+{
+	uint16_t timer;		///< Low 16 bits of the timeElement's address; the whole of it on the AVR.
+	uint16_t tick;		///< Low 16 bits of presentTime.
+	uint16_t counts;	///< Hardware counts since the tick began.
+	uint8_t kind;		///< A timerTraceKind_t.
+	uint8_t data;		///< Depends on kind.
+};
+
+template <uint8_t N>
+class TimerTrace
+{
+	static_assert (N > 0 && N <= 128 && 0 == (N & (N - 1)), "TIMER_TRACE_SIZE must be a power of two up to 128");
+	static_assert (sizeof (timerTraceEvent_t) == 8, "trace records are 8 bytes");
+
+public:
+	/// Constructor empties the recorder.
+	TimerTrace () : _head (0), _tail (0), _held (0), _dropped (0) {}
+
+	/// Store an event, dropping the oldest when full, or this one if the oldest is
+	/// held for a dump.  Call with interrupts disabled.
+	/**
+		\param e is the event.
+	*/
+	void Record (const timerTraceEvent_t &e)
+	{
+		if ((uint8_t) (_head - _tail) == N)
+		{
+			if (0xFFFF != _dropped)
+				_dropped++;
+			if (_held)
+				return;		// Keep the run the dump's header counted.
+			_tail++;
+		}
+		_buf [_head++ & (N - 1)] = e;
+	}
+
+	/// Reserve the events held for a dump, so that Record () keeps them until they
+	/// are popped.  Call with interrupts disabled.
+	/**
+		\return the number of events reserved.
+	*/
+	uint8_t Hold () {return _held = GetCount ();}
+
+	/// Take the oldest event, releasing it if held.  Call with interrupts disabled.
+	/**
+		\param e receives the event.
+		\return false if the recorder is empty.
+	*/
+	bool Pop (timerTraceEvent_t &e)
+	{
+		if (_tail == _head)
+			return false;
+		e = _buf [_tail++ & (N - 1)];
+		if (_held)
+			_held--;
+		return true;
+	}
+
+	/// Request the number of events held.
+	/**
+		\return the number of events recorded and not yet popped.
+	*/
+	uint8_t GetCount () const {return _head - _tail;}
+
+	/// Request and forget the number of events dropped.  Call with interrupts disabled.
+	/**
+		\return the events dropped since the last call, saturating at 0xFFFF.
+	*/
+	uint16_t TakeDropped ()
+	{
+		uint16_t d = _dropped;
+
+		_dropped = 0;
+		return d;
+	}
+
+private:
+	timerTraceEvent_t _buf [N];
+	uint8_t _head;			///< Next record to fill.
+	uint8_t _tail;			///< Oldest record held.
+	uint8_t _held;			///< Records a dump has counted and not yet popped.
+	uint16_t _dropped;		///< Records overwritten before they were popped.
+};
+
+#endif // TIMER_TRACE_H
@@ -0,0 +1,211 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerWheel.cpp - Source file for the hierarchical timing wheel.
+///
+/// See TimerWheel.h.  The wheel is only compiled when TIMER_ENGINE selects it.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "Timer.h"
+
+#if TIMER_ENGINE == TIMER_ENGINE_WHEEL
+
+/// Constructor empties every slot.  Timer's presentTime starts at 0, so the first
+/// tick the wheel processes is tick 1.
+TimerWheel::TimerWheel ()
+	: _due (0), _base (1), _count (0)
+{
+	for (uint8_t l=0; l<TIMER_WHEEL_LEVELS; l++)
+		for (uint8_t s=0; s<TIMER_WHEEL_SLOTS; s++)
+			_slot [l][s] = 0;
+}
+
+/// Link a timer into the slot for its timeOut and count it.
+/**
+	\param pTE points to a timeElement that is not already in the wheel.
+*/
+void TimerWheel::Insert (const p_timeElement pTE)
+{
+	Link (pTE);
+	_count++;
+}
+
+/// Choose the level from the distance to the timeOut and the slot from the timeOut
+/// itself.  A timer less than TIMER_WHEEL_SLOTS ticks away goes in level 0 and fires
+/// when that slot comes around; farther timers wait in a higher level until the
+/// cascade brings them down.  A timer whose timeOut has already been processed is
+/// overdue and goes straight to the due list.
+/**
+	\param pTE points to a timeElement that is not already in the wheel.
+*/
+void TimerWheel::Link (const p_timeElement pTE)
+{
+	timerTime_t to = pTE->getTimeOut (), base = _base;
+	timerTime_t delta = to - base;
+	uint8_t level = 0;
+
+	if (timerBefore (to, base))
+	{
+		pTE->linkAt (&_due);
+		return;
+	}
+
+	for ( ; level < TIMER_WHEEL_LEVELS - 1 && (delta >> TIMER_WHEEL_BITS); level++)
+	{
+		delta >>= TIMER_WHEEL_BITS;
+		to >>= TIMER_WHEEL_BITS;
+		base >>= TIMER_WHEEL_BITS;
+	}
+
+	// Beyond the top level:  park in the last slot of its revolution.
+	if (delta >> TIMER_WHEEL_BITS)
+		to = base - 1;
+
+	pTE->linkAt (&_slot [level][to & (TIMER_WHEEL_SLOTS - 1)]);
+}
+
+/// Unlink a timer from its slot (or the due list).  Timers not in the wheel are
+/// ignored.
+/**
+	\param pTE points to the timeElement to be removed.
+*/
+void TimerWheel::Remove (const p_timeElement pTE)
+{
+	if (!Contains (pTE))
+		return;
+
+	pTE->unlink ();
+	_count--;
+}
+
+/// Process the next tick.  When the index of a level wraps to zero, the current slot
+/// of the level above is emptied and its timers linked again relative to the new
+/// base; none of them is due before this tick, so they all land in a lower level or
+/// in a later revolution.  Finally the level 0 slot for this tick becomes the due list.
+void TimerWheel::Expire ()
+{
+	timerTime_t index = _base;
+
+	for (uint8_t level=1; level < TIMER_WHEEL_LEVELS && 0 == (index & (TIMER_WHEEL_SLOTS - 1)); level++)
+	{
+		index >>= TIMER_WHEEL_BITS;
+
+		p_timeElement *head = &_slot [level][index & (TIMER_WHEEL_SLOTS - 1)];
+		p_timeElement pTE = *head;
+
+		*head = 0;
+		while (pTE)
+		{
+			p_timeElement next = pTE->_next;
+			Link (pTE);
+			pTE = next;
+		}
+	}
+
+	// Splice the slot onto the due list, which Timer has normally emptied already.
+	p_timeElement *head = &_slot [0][_base & (TIMER_WHEEL_SLOTS - 1)];
+	while (*head)
+	{
+		p_timeElement pTE = *head;
+		pTE->unlink ();
+		pTE->linkAt (&_due);
+	}
+
+	_base++;
+}
+
+/// Find the first non-empty slot of each level at or after its present index.  A
+/// level 0 slot k places from the present index is due in k ticks; a higher level
+/// slot is cascaded at the start of its block.  Should the levels span more than
+/// the 32-bit time base, the top level uses fewer than TIMER_WHEEL_SLOTS slots.
+/**
+	\return a lower bound on the idle ticks, at most 0x7FFF.
+*/
+uint16_t TimerWheel::Idle () const
+{
+	uint32_t idle = 0x7FFF, offset = 0;
+	timerTime_t base = _base;
+
+	if (_due)
+		return 0;		// Overdue timers await the next tick.
+
+	for (uint8_t level=0; level<TIMER_WHEEL_LEVELS; level++)
+	{
+		uint8_t bits = 32 - TIMER_WHEEL_BITS * level;
+		uint8_t span = bits < TIMER_WHEEL_BITS ? 1 << bits : TIMER_WHEEL_SLOTS;
+		uint8_t index = base & (span - 1);
+
+		// The present block of a higher level was cascaded at its start unless that
+		// start is the tick about to be processed, so its slot comes around last.
+		uint8_t first = (0 == offset) ? 0 : 1;
+
+		for (uint8_t k=first; k<first+span; k++)
+			if (_slot [level][(index + k) & (span - 1)])
+			{
+				uint32_t ticks = ((uint32_t) k << (TIMER_WHEEL_BITS * level)) - offset;
+
+				if (ticks < idle)
+					idle = ticks;
+				break;
+			}
+
+		offset |= (uint32_t) (base & (TIMER_WHEEL_SLOTS - 1)) << (TIMER_WHEEL_BITS * level);
+		base >>= TIMER_WHEEL_BITS;
+	}
+	return idle;
+}
+
+/// Take the next timer from the due list.
+/**
+	\return a pointer to the unlinked timeElement or 0 when none remain.
+*/
+p_timeElement TimerWheel::Pop ()
+{
+	p_timeElement pTE = _due;
+
+	if (pTE)
+	{
+		pTE->unlink ();
+		_count--;
+	}
+	return pTE;
+}
+
+/// Look for a non-empty level 0 slot among the ticks of a window.  A level 0 slot
+/// only ever holds timers due at one tick within TIMER_WHEEL_SLOTS of the base.
+/**
+	\param lo is the start of the window.
+	\param hi is the end of the window, inclusive.
+	\param t receives the timeOut found.
+	\return true if a timer is due within the window.
+*/
+bool TimerWheel::Find (const timerTime_t lo, const timerTime_t hi, timerTime_t &t) const
+{
+	timerTime_t tick = timerBefore (lo, _base) ? _base : lo;
+
+	for ( ; !timerBefore (hi, tick) && tick - _base < TIMER_WHEEL_SLOTS; tick++)
+		if (_slot [0][tick & (TIMER_WHEEL_SLOTS - 1)])
+		{
+			t = tick;
+			return true;
+		}
+	return false;
+}
+
+/// Asks whether a timer is linked into the wheel (or its due list).
+/**
+	\param pTE points to the timeElement in question.
+	\return true if pTE is in the wheel.
+*/
+bool TimerWheel::Contains (const p_timeElement pTE)
+{
+	return 0 != pTE->_pprev;
+}
+
+#endif // TIMER_ENGINE_WHEEL
@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerWheel.h - Header file for the hierarchical timing wheel.
+///
+/// The wheel is the queue behind Timer when TIMER_ENGINE is TIMER_ENGINE_WHEEL.
+/// Instead of keeping every timer in one sorted queue, the wheel has
+/// TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots.  Level 0 holds the timers
+/// due within the next TIMER_WHEEL_SLOTS ticks, one slot per tick; each higher level
+/// spans TIMER_WHEEL_SLOTS times the ticks of the level below it.  When the level 0
+/// index wraps, the current slot of level 1 is redistributed (cascaded) into the
+/// lower levels, and so on up the hierarchy.
+///
+/// Each slot is an unsorted, doubly linked list threaded through the timeElements
+/// themselves, so
+///
+///		Insert		O(1)	compute the level and slot and link at the head,
+///		Remove		O(1)	unlink,
+///		Expire		O(1)	amortized; every timer is cascaded at most once per level.
+///
+/// RAM cost is TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS slot pointers plus two link
+/// pointers in each timeElement.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <inttypes.h>
+
+#ifndef TIMER_WHEEL_BITS
+	#define TIMER_WHEEL_BITS 4		///< log2 of the number of slots per level.
+#endif
+
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)	///< Slots per level.
+
+#ifndef TIMER_WHEEL_LEVELS
+	/// Enough levels to span 65536 ticks.  Timers beyond the top level are parked
+	/// there and cascaded again each time it comes around, so more levels only
+	/// save cascades of very long timers while fewer levels save RAM.
+	#define TIMER_WHEEL_LEVELS ((16 + TIMER_WHEEL_BITS - 1) / TIMER_WHEEL_BITS)
+#endif
+
+class timeElement;
+typedef timeElement *p_timeElement;
+typedef uint32_t timerTime_t;
+
+class TimerWheel
+{
+public:
+	/// Constructor empties every slot.  The first tick to be processed is tick 1.
+	TimerWheel ();
+
+	/// Link a timer into the slot for its timeOut, or into the due list if that
+	/// tick has already been processed.
+	/**
+		\param pTE points to a timeElement that is not already in the wheel.
+	*/
+	void Insert (const p_timeElement pTE);
+
+	/// Unlink a timer from whatever slot holds it.  Timers not in the wheel are ignored.
+	/**
+		\param pTE points to the timeElement to be removed.
+	*/
+	void Remove (const p_timeElement pTE);
+
+	/// Process the next tick:  cascade the higher levels if needed and move the
+	/// timers due at this tick to the due list, from which Pop () takes them.
+	void Expire ();
+
+	/// Request how many ticks, starting with the next one to be processed, would
+	/// find nothing to cascade or expire.  Used to skip idle ticks when tickless.
+	/**
+		\return a lower bound on the idle ticks, at most 0x7FFF.
+	*/
+	uint16_t Idle () const;
+
+	/// Pass over idle ticks without processing them.
+	/**
+		\param ticks must not exceed the value returned by Idle ().
+	*/
+	void Skip (const timerTime_t ticks) {_base += ticks;}
+
+	/// Take the next timer from the due list.
+	/**
+		\return a pointer to the unlinked timeElement or 0 when none remain.
+	*/
+	p_timeElement Pop ();
+
+	/// Find the earliest timeOut of a queued timer within a window.  Used to
+	/// coalesce timers that have slack (TIMER_SLACK).  Only the level 0 slots,
+	/// the next TIMER_WHEEL_SLOTS ticks, are searched.
+	/**
+		\param lo is the start of the window.
+		\param hi is the end of the window, inclusive.
+		\param t receives the timeOut found.
+		\return true if a timer is due within the window.
+	*/
+	bool Find (const timerTime_t lo, const timerTime_t hi, timerTime_t &t) const;
+
+	/// Asks whether a timer is linked into the wheel (or its due list).
+	/**
+		\param pTE points to the timeElement in question.
+		\return true if pTE is in the wheel.
+	*/
+	static bool Contains (const p_timeElement pTE);
+
+	/// Retrieve the number of timers in the wheel.
+	/**
+		\return the number of timers linked into the wheel.
+	*/
+	uint16_t GetCount () const {return _count;}
+
+protected:
+	void Link (const p_timeElement pTE);	///< Insert without counting.
+
+private:
+	p_timeElement _slot [TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	p_timeElement _due;	///< Timers expired by the last Expire () and not yet popped.
+	timerTime_t _base;	///< The next tick to be processed.
+	uint16_t _count;		///< Number of timers in the wheel.
+};
+
+#endif // TIMER_WHEEL_H
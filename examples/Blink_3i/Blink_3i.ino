@@ -33,16 +33,9 @@ private:
 
 LED led[3] = {13, 12, 11};  // LEDs on pins 11-13.
 
-// The callback function called at regular intervals.
-// The argument is a pointer to the particular LED
-// that needs blinked presently.
-void callBack (void *pArg){
-  static_cast<LED *>(pArg)->blinkMe ();
-}
-
 // The timer's data objects.  Assign the timers' periods.
-// 0x100 = 256 decimal results in 1.049 second period with the
-// default timer prescaler (256).  Use configTimers to change
+// 0x100 = 256 decimal results in a 4.1 millisecond period with the
+// default timer prescaler (1).  Use configTimers to change
 // the prescaler.  Use setRepeats to to cause the timer to
 // execute up to 65535 more alarms and to stop.  These three
 // initializers result in pin 13 on/off in 0.9994 seconds
@@ -54,22 +47,39 @@ void callBack (void *pArg){
 //               F_CPU
 //
 // The values (x) are assigned to timePeriod in the constructor.
+//
+// Built with TIMER_AUTOSCALE defined as 1, the library picks the
+// prescaler itself.  These periods are all multiples of 256 ticks,
+// so once their first expirations fall on such a tick too, it
+// interrupts once every 256 ticks instead of every tick.
 timeElement timerData [3] = {0xF400, 0x7A00, 0x5100};
 
 void setup()
 {
+#if !TIMER_AUTOSCALE
   // Change the timer prescaler (p) to 1.  This will make the
   // timer resolution 16 microseconds.
   timer.configTimers (1);
+#endif
   for (uint8_t i=0; i<3; i++) {
     pinMode (led [i].getPinNumber (), OUTPUT);
-    timerData [i].setArg (&led [i]);
-    timerData [i].setCallBack (callBack);
-    timer.startTimer (&timerData [i]);
+    // Each timer calls blinkMe () on its own LED.
+    timerData [i].setCallBack<LED, &LED::blinkMe> (&led [i]);
   }
+#if TIMER_AUTOSCALE
+  // Start all three from the same multiple of 256 ticks, so that
+  // they stay in step and share the coarse interrupts.
+  timerTime_t start = (timer.getPresentTime () + 0x1FF) & ~(timerTime_t) 0xFF;
+  for (uint8_t i=0; i<3; i++)
+    timer.rescheduleTimer (&timerData [i], start + timerData [i].getTimePeriod ());
+#else
+  // Start all three from the same tick so they stay in step.
+  timer.startTimers (timerData);
+#endif
 }
 
 void loop() // The processor can be doing anything here while the timers run.
 {
-
+  // With nothing else to do, sleep until the next LED is due.
+  timer.idleUntilNextTimer ();
 }
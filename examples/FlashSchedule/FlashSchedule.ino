@@ -0,0 +1,43 @@
+//////////////////////////////////////////////////////////////////////
+// Blink five LEDs from a schedule kept in flash.  Each LED toggles
+// at its own prime period; the last two start half a period late,
+// and the first stops after 40 toggles.  The periods, callbacks and
+// arguments never leave flash:  the TimerFlash keeps only each
+// LED's next deadline and toggles left in SRAM, 6 bytes an LED,
+// and the whole schedule is one timer in the queue.
+//
+// At the default prescaler a tick is 256 CPU cycles, 16 us at
+// 16 MHz, so 6250 ticks are 100 ms.
+//////////////////////////////////////////////////////////////////////
+
+#include <Timer.h>
+#include <TimerFlash.h>
+Timer timer;
+
+const uint8_t pins [5] = {13, 12, 11, 10, 9};
+
+void toggle (void *pin) {
+  uint8_t p = *static_cast<const uint8_t *> (pin);
+  digitalWrite (p, !digitalRead (p));
+}
+
+// Period, repeats (0 = forever), callback, argument and phase.
+const timerSchedule_t blinks [5] PROGMEM = {
+  {6250 * 2,  40, toggle, (void *) &pins [0], 0},
+  {6250 * 3,  0,  toggle, (void *) &pins [1], 0},
+  {6250 * 5,  0,  toggle, (void *) &pins [2], 0},
+  {6250 * 7,  0,  toggle, (void *) &pins [3], 6250 * 7 / 2},
+  {6250 * 11, 0,  toggle, (void *) &pins [4], 6250 * 11 / 2}};
+
+TimerFlash<5> leds (timer, blinks);
+
+void setup() {
+  for (uint8_t i=0; i<5; i++)
+    pinMode (pins [i], OUTPUT);
+  leds.start ();
+}
+
+void loop() {
+  // With nothing else to do, sleep until the next LED is due.
+  timer.idleUntilNextTimer ();
+}
@@ -0,0 +1,54 @@
+//////////////////////////////////////////////////////////////////////
+// A sequence written as one routine.  Each cycle raises a pin,
+// waits 20 ticks for the sensor it powers to settle, samples it,
+// lowers the pin and rests 5 ticks.  TIMER_AWAIT() returns from
+// run() and the timer calls run() again where it left off, so no
+// chain of callbacks is needed and loop() stays free.
+//
+// At the default prescaler a tick is 256 CPU cycles, 16 us at
+// 16 MHz.  Another sensor on another pin is just another Sensor
+// object; each costs a few bytes of RAM and no stack.
+//////////////////////////////////////////////////////////////////////
+
+#include <Timer.h>
+#include <TimerCoroutine.h>
+Timer timer;
+
+class Sensor : public TimerThread {
+public:
+  Sensor (uint8_t power, uint8_t input) : level (0), _power (power), _input (input) {}
+  void begin () {
+    pinMode (_power, OUTPUT);
+    start ();
+  }
+  volatile int level;     // The latest sample.
+protected:
+  void run () {
+    TIMER_THREAD_BEGIN ();
+    for (;;) {
+      digitalWrite (_power, HIGH);
+      TIMER_AWAIT (timer.sleep (20));
+      level = analogRead (_input);
+      digitalWrite (_power, LOW);
+      TIMER_AWAIT (timer.sleep (5));
+    }
+    TIMER_THREAD_END ();
+  }
+private:
+  uint8_t _power, _input; // Members, not locals, survive TIMER_AWAIT().
+};
+
+Sensor left (2, A0), right (3, A1);
+
+void setup() {
+  Serial.begin (9600);
+  left.begin ();
+  right.begin ();
+}
+
+void loop() {
+  Serial.print (left.level);
+  Serial.print (' ');
+  Serial.println (right.level);
+  timer.delay (500);
+}
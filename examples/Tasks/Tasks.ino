@@ -0,0 +1,68 @@
+//////////////////////////////////////////////////////////////////////
+// Three cooperative tasks share the processor.  A sampler reads an
+// analog input every 10 ms and must finish within 2 ms, a blinker
+// toggles the LED twice a second, and a reporter prints over the
+// serial port once a second.  The Timer's interrupt only releases
+// the tasks; loop() runs their jobs, earliest deadline first, so the
+// serial output never runs in the ISR.  Jobs are not preempted: a
+// sample released while the report prints waits for it, and the
+// next report shows whether that cost a deadline.
+//
+// At the default prescaler a tick is 256 CPU cycles, 16 us at
+// 16 MHz, so 625 ticks are 10 ms.
+//////////////////////////////////////////////////////////////////////
+
+#include <Timer.h>
+#include <TimerScheduler.h>
+Timer timer;
+TimerScheduler tasks (timer, TIMER_EDF);
+
+volatile int level;       // The latest sample.
+long sum;                 // Samples summed since the last report.
+unsigned count;
+
+void sample (void *) {
+  level = analogRead (A0);
+  sum += level;
+  count++;
+}
+
+void blink (void *) {
+  digitalWrite (LED_BUILTIN, !digitalRead (LED_BUILTIN));
+}
+
+void report (void *);
+
+timerTask sampler (sample, 0, 625);       // Every 10 ms,
+timerTask blinker (blink, 0, 31250);      // 500 ms,
+timerTask reporter (report, 0, 62500);    // and 1 s.
+
+void report (void *) {
+  Serial.print ("mean ");
+  Serial.print (count ? sum / count : 0);
+  Serial.print ("  samples ");
+  Serial.print (sampler.getRuns ());
+  Serial.print ("  missed ");
+  Serial.print (sampler.getMisses ());
+  Serial.print ("  worst ");
+  Serial.print (sampler.getWorst () * 16);
+  Serial.println (" us");
+  sum = 0;
+  count = 0;
+  sampler.resetStats ();
+}
+
+void setup() {
+  Serial.begin (9600);
+  pinMode (LED_BUILTIN, OUTPUT);
+
+  sampler.setDeadline (125);              // 2 ms.
+  tasks.start (sampler);
+  tasks.start (blinker);
+  tasks.start (reporter);
+}
+
+void loop() {
+  tasks.run ();           // Run every released job,
+  tasks.idle ();          // then sleep until an interrupt.
+}
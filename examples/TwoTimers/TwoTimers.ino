@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////
+// Run two independent schedulers on two hardware timers.  A fast one
+// on Timer/Counter 2 ticks every 128 microseconds and toggles pin 8
+// every 512 microseconds.  A slow one on Timer/Counter 1 ticks every
+// 16.4 milliseconds, blinks the LED on pin 13 once a second and
+// reports over the serial port every five seconds.  The slow work
+// never shares the fast timer's interrupt rate, and neither timer
+// uses Timer/Counter 0, which keeps millis () running.
+//
+// No global "timer" object is needed when only TimerT objects are
+// used.
+////////////////////////////////////////////////////////////////////////
+
+#include <TimerT.h>
+
+TimerT<4, 2, 8> fast;       // 256 * 8 / 16 MHz = 128 us per tick.
+TimerT<4, 1, 1024> slow;    // 256 * 1024 / 16 MHz = 16.384 ms per tick.
+
+TIMER_ISR (2, fast);
+TIMER_ISR (1, slow);
+
+volatile unsigned long edges;
+
+void toggle (void *pArg) {
+  int pin = (int) (intptr_t) pArg;
+  digitalWrite (pin, !digitalRead (pin));
+  if (8 == pin)
+    edges++;
+}
+
+void report (void *) {
+  Serial.print (millis ());
+  Serial.print (" ms, ");
+  Serial.print (edges);
+  Serial.println (" edges on pin 8");
+}
+
+// The periods are converted to ticks at compile time; a period
+// shorter than one tick of its timer does not compile.
+timeElement square (fast.us<512> ());
+timeElement blink (slow.ms<500> ());
+timeElement status (slow.ms<5000> ());
+
+void setup()
+{
+  Serial.begin (9600);
+  pinMode (8, OUTPUT);
+  pinMode (13, OUTPUT);
+
+  // init () has put both hardware timers in PWM mode since the
+  // objects were constructed.
+  fast.begin ();
+  slow.begin ();
+
+  square.setCallBack (toggle);
+  square.setArg ((void *) 8);
+  blink.setCallBack (toggle);
+  blink.setArg ((void *) 13);
+  status.setCallBack (report);
+
+  fast.startTimer (&square);
+  slow.startTimer (&blink);
+  slow.startTimer (&status);
+}
+
+void loop() // Both schedulers run from their own interrupts.
+{
+
+}
@@ -0,0 +1,147 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerBench.cpp - Host benchmark for the Timer class and its queues.
+///
+/// The library is built against the virtual Timer/Counter 2 of TimerSim and the
+/// clock is run forward so that NextTick () executes exactly as it would in
+/// ISR (TIMER2_OVF_vect).  For each number of live timeElements the benchmark
+/// reports
+///
+///		insert/s		startTimer () calls per second while filling the queue,
+///		ns/tick		wall time per overflow interrupt, callbacks included,
+///		ns/cancel	wall time per cancelTimer () in random order,
+///		fired			callbacks executed during the timed ticks,
+///		irqs			timer interrupts taken during the timed ticks.
+///
+/// Sizes larger than the queue can hold are reported as n/a.  The numbers measure
+/// the algorithms on the host; they are for comparing scheduler changes, not for
+/// predicting AVR cycle counts.
+///
+/// Build and run from this directory:
+///
+///		g++ -O2 -I../.. -o TimerBench TimerBench.cpp ../../Timer.cpp ../../TimerQueue.cpp
+///			../../TimerWheel.cpp ../../TimerHeap.cpp ../../TimerSim.cpp
+///		./TimerBench
+///
+/// (one command line).  Add -DTIMER_ENGINE=TIMER_ENGINE_WHEEL to measure the wheel,
+/// -DTIMER_ENGINE=TIMER_ENGINE_HEAP -DTIMER_HEAP_SIZE=10000 to measure the heap and
+/// -DTIMER_TICKLESS=1 to measure the compare-match mode, or -DTIMER_AUTOSCALE=1,
+/// whose tick is always 256 CPU cycles, to measure the self-scaling prescaler.
+///
+/// The header line gives the RAM each timer costs on the host:  its timeElement plus
+/// the heap entry the Timer reserves for it.  Pointers are 8 bytes here and
+/// 2 on the AVR, so compare engines with one another, not with the part.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "Timer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+Timer timer;
+
+static const uint32_t benchTicks = 20000;		///< Overflows timed per size.
+static const unsigned benchSizes [] = {5, 10, 50, 100, 250, 500, 1000, 5000, 10000};
+
+static unsigned long fired;
+
+static void countIt (void *)
+{
+	fired++;
+}
+
+static double nanoseconds (std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - start).count ();
+}
+
+/// Run one size.  The periods are pseudo-random but repeatable so that two builds
+/// of the library see the same schedule.
+static void benchSize (unsigned n)
+{
+	std::vector<timeElement> te (n);
+	std::vector<unsigned> order (n);
+
+	srand (n);
+	for (unsigned i=0; i<n; i++)
+	{
+		te [i].setPeriod (16 + rand () % 4096);
+		te [i].setCallBack (countIt);
+		te [i].setArg (0);
+		order [i] = i;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+	for (unsigned i=0; i<n; i++)
+	{
+		if (timer.isFull ())
+		{
+			printf ("%7u   %12s %10s %10s %10s %10s\n", n, "n/a", "n/a", "n/a", "n/a", "n/a");
+			for (unsigned j=0; j<i; j++)
+				timer.cancelTimer (&te [j]);
+			return;
+		}
+		timer.startTimer (&te [i]);
+	}
+	double insertNs = nanoseconds (start);
+
+	fired = 0;
+	uint32_t irqs = TimerSim::interruptCount ();
+	start = std::chrono::steady_clock::now ();
+	TimerSim::advance (benchTicks * 256UL);
+	double tickNs = nanoseconds (start);
+	irqs = TimerSim::interruptCount () - irqs;
+
+	for (unsigned i=n-1; i>0; i--)
+	{
+		unsigned j = rand () % (i + 1), t = order [i];
+		order [i] = order [j];
+		order [j] = t;
+	}
+	start = std::chrono::steady_clock::now ();
+	for (unsigned i=0; i<n; i++)
+		timer.cancelTimer (&te [order [i]]);
+	double cancelNs = nanoseconds (start);
+
+	printf ("%7u   %12.0f %10.1f %10.1f %10lu %10lu\n", n, n * 1e9 / insertNs,
+		tickNs / benchTicks, cancelNs / n, fired, (unsigned long) irqs);
+}
+
+int main ()
+{
+#if !TIMER_AUTOSCALE
+	timer.configTimers (1);		// 256 CPU cycles per tick.
+#endif
+
+#if TIMER_ENGINE == TIMER_ENGINE_HEAP
+	const unsigned entry = sizeof (p_timeElement);
+#else
+	const unsigned entry = 0;
+#endif
+
+	printf ("engine %s, sizeof (timeElement) = %u bytes, %u bytes per timer\n\n",
+		TIMER_ENGINE == TIMER_ENGINE_WHEEL ? "wheel" : TIMER_ENGINE == TIMER_ENGINE_HEAP ? "heap" : "list",
+		(unsigned) sizeof (timeElement), (unsigned) sizeof (timeElement) + entry);
+	printf ("%7s   %12s %10s %10s %10s %10s\n", "timers", "insert/s", "ns/tick", "ns/cancel", "fired", "irqs");
+
+	// Baseline:  the cost of the simulated clock and an empty queue.
+	uint32_t irqs = TimerSim::interruptCount ();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+	TimerSim::advance (benchTicks * 256UL);
+	printf ("%7u   %12s %10.1f %10s %10s %10lu\n", 0, "-", nanoseconds (start) / benchTicks, "-", "-",
+		(unsigned long) (TimerSim::interruptCount () - irqs));
+
+	for (unsigned i=0; i<sizeof (benchSizes) / sizeof (benchSizes [0]); i++)
+		benchSize (benchSizes [i]);
+
+	return 0;
+}
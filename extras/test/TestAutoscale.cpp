@@ -0,0 +1,98 @@
+// flags: -DTIMER_AUTOSCALE=1 -DTIMER_ENGINE=0|-DTIMER_AUTOSCALE=1 -DTIMER_ENGINE=1|-DTIMER_AUTOSCALE=1 -DTIMER_ENGINE=2
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TestAutoscale.cpp - The prescaler chosen by TIMER_AUTOSCALE.
+///
+/// Timers started on any tick expire on their exact ticks, never early, however
+/// coarse the division was when they started, and the clock keeps to the CPU
+/// cycles through any number of changes of division.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "Timer.h"
+#include "TimerTest.h"
+
+Timer timer;
+
+static timerTime_t fired [4];
+static uint8_t fires;
+
+static void record (void *)
+{
+	if (fires < 4)
+		fired [fires] = timer.getPresentTime ();
+	fires++;
+}
+
+/// Check that the clock agrees with the CPU cycles run.
+/**
+	\return true if now () is within one count of the coarsest division.
+*/
+static bool inStep ()
+{
+	uint32_t lag = (uint32_t) TimerSim::cycles () - timer.now ();
+
+	return lag + 1024 <= 2048;
+}
+
+/// A one-shot and a periodic timer started between the ticks of a coarse division.
+static void testExact ()
+{
+	TimerSim::advance (77 * 256 + 100);		// No timers:  division 1024.
+
+	timeElement shot (1024, 1);
+	timerTime_t start = timer.getPresentTime ();
+
+	shot.setCallBack (record);
+	fires = 0;
+	TIMER_CHECK (timer.startTimer (&shot));
+	TimerSim::advance (2000 * 256);
+	TIMER_CHECK (1 == fires);
+	TIMER_CHECK (start + 1024 == fired [0]);
+
+	TimerSim::advance (333 * 256);
+
+	timeElement blink (0x7A00, 3);
+
+	start = timer.getPresentTime ();
+	blink.setCallBack (record);
+	fires = 0;
+	TIMER_CHECK (timer.startTimer (&blink));
+	TimerSim::advance (4 * 0x7A00 * 256);
+	TIMER_CHECK (3 == fires);
+	for (uint8_t i=0; i<3; i++)
+		TIMER_CHECK (start + (i + 1) * 0x7A00 == fired [i]);
+	TIMER_CHECK (0 == timer.getCount ());
+}
+
+/// Switch between fine and coarse divisions many times at awkward moments.
+static void testNoDrift ()
+{
+	TIMER_CHECK (inStep ());
+	for (unsigned i=0; i<500; i++)
+	{
+		timeElement fine (3, 2);
+
+		fine.setCallBack (record);
+		TimerSim::advance (1000 + 37 * (i % 29));
+		TIMER_CHECK (timer.startTimer (&fine));
+		TimerSim::advance (4000 + 53 * (i % 31));
+		timer.cancelTimer (&fine);
+	}
+	TimerSim::advance (5000 * 256);
+	TIMER_CHECK (inStep ());
+	TIMER_CHECK (0 == timer.getCount ());
+}
+
+int main ()
+{
+	testExact ();
+	testNoDrift ();
+	return TimerTestResult ();
+}
@@ -0,0 +1,102 @@
+// flags: -DTIMER_ENGINE=0|-DTIMER_ENGINE=1|-DTIMER_ENGINE=2|-DTIMER_ENGINE=0 -DTIMER_CAPTURE_SIZE=16|-DTIMER_ENGINE=2 -DTIMER_CAPTURE_SIZE=16
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TestCallBack.cpp - Lambdas and member functions as callbacks.
+///
+/// A lambda that captures no more than a pointer is kept in the argument, and one
+/// that captures more in the room TIMER_CAPTURE_SIZE reserves.  Either way a copy
+/// of the timeElement calls its own copy of the lambda.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "Timer.h"
+#include "TimerTest.h"
+
+Timer timer;
+
+struct Counter
+{
+	unsigned n;
+
+	void bump () {n++;}
+};
+
+/// Run one timer through three repetitions.
+/**
+	\param te is the timer, already given its callback.
+*/
+static void runOut (timeElement &te)
+{
+	te.setRepeats (3);
+	TIMER_CHECK (timer.startTimer (&te));
+	TimerSim::advance (20 * 256);
+	TIMER_CHECK (!te.isRunning ());
+}
+
+/// Lambdas small enough for the argument, with and without captures.
+static void testInPlace ()
+{
+	static unsigned plain;
+	Counter c = {0};
+	timeElement te (2, 3);
+	auto bump = [&c] {c.n++;};
+
+	static_assert (sizeof (bump) <= sizeof (void *), "a reference capture fits in a pointer");
+	te.setCallBack (bump);
+	runOut (te);
+	TIMER_CHECK (3 == c.n);
+
+	te.setCallBack ([] {plain++;});
+	runOut (te);
+	TIMER_CHECK (3 == plain);
+
+	timeElement copy (1, 1);
+
+	te.setCallBack (bump);
+	copy = te;
+	runOut (copy);
+	TIMER_CHECK (6 == c.n);
+}
+
+/// A member function bound to its object.
+static void testMember ()
+{
+	Counter c = {0};
+	timeElement te (2, 3);
+
+	te.setCallBack<Counter, &Counter::bump> (&c);
+	runOut (te);
+	TIMER_CHECK (3 == c.n);
+}
+
+#if TIMER_CAPTURE_SIZE >= 16
+/// A lambda capturing two pointers is kept in _capture, and a copy uses its own.
+static void testCaptured ()
+{
+	Counter a = {0}, b = {0};
+	timeElement te (2, 3), copy (1, 1);
+	auto make = [] (Counter *x, Counter *y) {return [x, y] {x->n++; y->n += 2;};};
+
+	te.setCallBack (make (&a, &b));
+	copy = te;
+	te.setCallBack (make (&b, &a));		// Overwrites te's copy, not copy's.
+	runOut (copy);
+	TIMER_CHECK (3 == a.n && 6 == b.n);
+}
+#endif
+
+int main ()
+{
+	testInPlace ();
+	testMember ();
+#if TIMER_CAPTURE_SIZE >= 16
+	testCaptured ();
+#endif
+	return TimerTestResult ();
+}
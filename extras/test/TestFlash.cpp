@@ -0,0 +1,120 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TestFlash.cpp - A schedule run from flash.
+///
+/// Every entry expires at its phase plus whole periods from start (), stops after
+/// its repeats, and takes no place in the queue of its own.  A callback may stop
+/// the schedule.  The schedule costs less SRAM than its timeElements would.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "Timer.h"
+#include "TimerFlash.h"
+#include "TimerTest.h"
+
+Timer timer;
+
+/// Ticks in a unit of the schedules whose timing is checked:  coarse enough for
+/// TIMER_AUTOSCALE to expire a timer started from idle on its exact tick.
+#define UNIT 1024
+
+/// One entry's expirations, in units.
+struct Entry
+{
+	unsigned fires;
+	timerTime_t last;
+	bool late;			///< An expiration fell off the entry's ticks.
+	timerTime_t phase, period;
+};
+
+static Entry a = {0, 0, false, 0, 3}, b = {0, 0, false, 2, 5}, c = {0, 0, false, 0, 4};
+static timerTime_t start;
+
+static void fire (void *entry)
+{
+	Entry *e = static_cast<Entry *> (entry);
+	timerTime_t now = timer.getPresentTime () - start;
+
+	e->fires++;
+	if (now != (e->phase + e->fires * e->period) * UNIT)
+		e->late = true;
+	e->last = now / UNIT;
+}
+
+const timerSchedule_t table [3] PROGMEM = {
+	{3 * UNIT, 0, fire, &a, 0},
+	{5 * UNIT, 2, fire, &b, 2 * UNIT},
+	{4 * UNIT, 3, fire, &c, 0}};
+
+TimerFlash<3> flash (timer, table);
+
+static void stopAll (void *flash)
+{
+	static_cast<TimerFlash<2> *> (flash)->stop ();
+}
+
+extern TimerFlash<2> selfStop;
+
+const timerSchedule_t stopper [2] PROGMEM = {
+	{2, 0, stopAll, &selfStop, 0},
+	{2, 0, fire, &a, 0}};
+
+TimerFlash<2> selfStop (timer, stopper);
+
+/// The entries expire on their own ticks, and the finite ones stop.
+static void testSchedule ()
+{
+	start = timer.getPresentTime ();
+	TIMER_CHECK (flash.start ());
+	TIMER_CHECK (1 == timer.getCount ());
+	TimerSim::advance ((30 * UNIT + 1) * 256UL);
+	TIMER_CHECK (10 == a.fires && !a.late);
+	TIMER_CHECK (2 == b.fires && !b.late && 12 == b.last);
+	TIMER_CHECK (3 == c.fires && !c.late && 12 == c.last);
+	TIMER_CHECK (flash.isRunning ());
+	flash.stop ();
+	TIMER_CHECK (!flash.isRunning ());
+	TIMER_CHECK (0 == timer.getCount ());
+}
+
+/// A schedule whose entries all finish leaves the queue.
+static void testFinish ()
+{
+	static const timerSchedule_t once [2] PROGMEM = {
+		{1, 1, fire, &b, 0},
+		{2, 2, fire, &c, 0}};
+	TimerFlash<2> f (timer, once);
+
+	b.fires = c.fires = 0;
+	TIMER_CHECK (f.start ());
+	TimerSim::advance (20 * 256);
+	TIMER_CHECK (1 == b.fires && 2 == c.fires);
+	TIMER_CHECK (!f.isRunning ());
+	TIMER_CHECK (0 == timer.getCount ());
+}
+
+/// A callback that stops its schedule stops the entries after it too.
+static void testStopFromCallBack ()
+{
+	a.fires = 0;
+	TIMER_CHECK (selfStop.start ());
+	TimerSim::advance (20 * 256);
+	TIMER_CHECK (0 == a.fires);
+	TIMER_CHECK (!selfStop.isRunning ());
+	TIMER_CHECK (0 == timer.getCount ());
+}
+
+int main ()
+{
+	static_assert (sizeof (TimerFlash<8>) < 8 * sizeof (timeElement) / 2, "a schedule costs less than half its timeElements");
+	testSchedule ();
+	testFinish ();
+	testStopFromCallBack ();
+	return TimerTestResult ();
+}
@@ -0,0 +1,91 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TestOverflow.cpp - Ticks that pass while the ISR calls timers back.
+///
+/// Several timers due together whose callbacks take most of a tick each keep the
+/// ISR busy for several ticks.  The clock must count every one of them, and the
+/// timers due meanwhile must still fire.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "Timer.h"
+#include "TimerTest.h"
+
+Timer timer;
+
+static unsigned fires;
+
+/// Take 200 CPU cycles, most of a tick at prescaler division 1.
+static void busy (void *)
+{
+	fires++;
+	TimerSim::advance (200);
+}
+
+static void count (void *)
+{
+	fires++;
+}
+
+/// Check that the clock agrees with the CPU cycles run.
+/**
+	\return true if now () is within a tick of the cycles.
+*/
+static bool inStep ()
+{
+	uint32_t lag = (uint32_t) TimerSim::cycles () - timer.now ();
+
+	return lag + 256 <= 512;
+}
+
+/// Eight busy callbacks in one tick keep the ISR for over six ticks.
+static void testBusyTick ()
+{
+	timeElement slow [8];
+	timeElement tick (1, 0);
+
+	fires = 0;
+	for (timeElement &te : slow)
+	{
+		te.setPeriod (64);
+		te.setRepeats (5);
+		te.setCallBack (busy);
+	}
+	TIMER_CHECK (8 == timer.startTimers (slow));
+	TimerSim::advance (400 * 256);
+	TIMER_CHECK (40 == fires);
+	TIMER_CHECK (inStep ());
+
+	// A timer due every tick sees each of the ticks the busy ones took.
+	fires = 0;
+	for (timeElement &te : slow)
+	{
+		te.setRepeats (5);
+		TIMER_CHECK (timer.startTimer (&te));
+	}
+	tick.setCallBack (count);
+	TIMER_CHECK (timer.startTimer (&tick));
+
+	uint64_t start = TimerSim::cycles ();
+
+	TimerSim::advance (1000 * 256);
+	timer.cancelTimer (&tick);
+
+	unsigned ticks = (TimerSim::cycles () - start) / 256;	// The busy callbacks add theirs.
+
+	TIMER_CHECK (fires >= 40 + ticks - 1 && fires <= 40 + ticks + 1);
+	TIMER_CHECK (inStep ());
+	TIMER_CHECK (0 == timer.getCount ());
+}
+
+int main ()
+{
+	testBusyTick ();
+	return TimerTestResult ();
+}
@@ -0,0 +1,74 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TestOverrun.cpp - Late and degenerate periodic timers.
+///
+/// A timer with a period of 0 fires once each tick under every overrun policy,
+/// and stops after its repeats.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "Timer.h"
+#include "TimerTest.h"
+
+Timer timer;
+
+static unsigned fires;
+
+static void count (void *)
+{
+	fires++;
+}
+
+/// Run the clock until presentTime has advanced by some ticks.
+/**
+	\param ticks is the number of ticks.
+*/
+static void runTicks (const timerTime_t ticks)
+{
+	timerTime_t end = timer.getPresentTime () + ticks;
+
+	while (timerBefore (timer.getPresentTime (), end))
+		TimerSim::advance (64);
+}
+
+/// A period of 0 must neither hang the ISR nor fire more than once a tick.
+static void testPeriodZero ()
+{
+	static const timerOverrun_t policies [] = {TIMER_CATCHUP, TIMER_RESYNC, TIMER_SKIP};
+
+	for (const timerOverrun_t policy : policies)
+	{
+		timeElement te (0, 0);
+
+		te.setCallBack (count);
+		te.setOverrun (policy);
+		fires = 0;
+		TIMER_CHECK (timer.startTimer (&te));
+		runTicks (10);
+		TIMER_CHECK (fires >= 9 && fires <= 11);
+		timer.cancelTimer (&te);
+
+		timeElement three (0, 3);
+
+		three.setCallBack (count);
+		three.setOverrun (policy);
+		fires = 0;
+		TIMER_CHECK (timer.startTimer (&three));
+		runTicks (10);
+		TIMER_CHECK (3 == fires);
+		TIMER_CHECK (!three.isRunning ());
+	}
+	TIMER_CHECK (0 == timer.getCount ());
+}
+
+int main ()
+{
+	testPeriodZero ();
+	return TimerTestResult ();
+}
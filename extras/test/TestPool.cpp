@@ -0,0 +1,88 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TestPool.cpp - Occupancy of TimerPool slots.
+///
+/// A periodic timer's slot stays busy while its callback runs, so a start () from
+/// the callback takes another slot.  A slot is freed by cancel () and by the last
+/// repetition, and by nothing else.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "Timer.h"
+#include "TimerPool.h"
+#include "TimerTest.h"
+
+Timer timer;
+TimerPool<2> pool (timer);
+
+static unsigned ticks, shots;
+static timerHandle_t periodic, shot;
+
+static void once (void *)
+{
+	shots++;
+}
+
+/// Start a one-shot from the periodic timer's first callback.
+static void spawn (void *)
+{
+	if (0 == ticks++)
+	{
+		TIMER_CHECK (pool.isRunning (periodic));
+		shot = pool.start ({5, 1, once, 0});
+	}
+}
+
+/// Run the clock for some ticks.
+/**
+	\param n is the number of ticks.
+*/
+static void runTicks (const unsigned n)
+{
+	TimerSim::advance (n * 256UL);
+}
+
+/// The one-shot started from the callback must neither take the periodic timer's
+/// slot nor repeat.
+static void testStartFromCallback ()
+{
+	periodic = pool.start ({10, 0, spawn, 0});
+	TIMER_CHECK (0 != periodic.generation);
+	runTicks (100);
+	TIMER_CHECK (0 != shot.generation);
+	TIMER_CHECK (shot.index != periodic.index);
+	TIMER_CHECK (1 == shots);
+	TIMER_CHECK (ticks >= 9 && ticks <= 11);
+	TIMER_CHECK (pool.isRunning (periodic));
+	TIMER_CHECK (!pool.isRunning (shot));
+
+	// The one-shot's slot is free again; the periodic timer's is not.
+	timerHandle_t h = pool.start ({5, 1, once, 0});
+
+	TIMER_CHECK (h.index == shot.index);
+	TIMER_CHECK (0 == pool.start ({5, 1, once, 0}).generation);
+	runTicks (10);
+	TIMER_CHECK (2 == shots);
+
+	// cancel () frees the slot and retires the handle.
+	TIMER_CHECK (pool.cancel (periodic));
+	TIMER_CHECK (!pool.cancel (periodic));
+	TIMER_CHECK (0 == pool.get (periodic));
+	h = pool.start ({5, 1, once, 0});
+	TIMER_CHECK (h.index == periodic.index);
+	runTicks (10);
+	TIMER_CHECK (3 == shots);
+	TIMER_CHECK (0 == timer.getCount ());
+}
+
+int main ()
+{
+	testStartFromCallback ();
+	return TimerTestResult ();
+}
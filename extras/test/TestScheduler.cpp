@@ -0,0 +1,104 @@
+// flags: -DTIMER_ENGINE=0 -DTIMER_TICKLESS=1|-DTIMER_ENGINE=1 -DTIMER_TICKLESS=1|-DTIMER_ENGINE=2 -DTIMER_TICKLESS=1
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TestScheduler.cpp - The releases a TimerScheduler records.
+///
+/// A task is released at the tick its timer was due, whatever its overrun policy
+/// does with the next timeOut, so a late release shows in the response and the
+/// missed deadline.  One-shot tasks, with and without a period, are released when
+/// due too.  Tickless, a long callback leaves the other timers late.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "Timer.h"
+#include "TimerScheduler.h"
+#include "TimerTest.h"
+
+Timer timer;
+TimerScheduler tasks (timer);
+
+static unsigned jobs;
+
+static void job (void *)
+{
+	jobs++;
+}
+
+/// Keep the ISR for 35 ticks.
+static void hog (void *)
+{
+	TimerSim::advance (35 * 256);
+}
+
+/// Run the clock tick by tick, running the released jobs after each.
+/**
+	\param ticks is the number of ticks.
+*/
+static void runTicks (const unsigned ticks)
+{
+	for (unsigned i=0; i<ticks; i++)
+	{
+		TimerSim::advance (256);
+		tasks.run ();
+	}
+}
+
+/// A periodic task made late by a long callback counts its response from the
+/// deadline it was due at.
+/**
+	\param policy is the task's overrun policy.
+*/
+static void testLate (const timerOverrun_t policy)
+{
+	timerTask task (job, 0, 10);
+	timeElement slow (95, 1);
+
+	task.getTimer ().setOverrun (policy);
+	slow.setCallBack (hog);
+	jobs = 0;
+	TIMER_CHECK (tasks.start (task));
+	TIMER_CHECK (timer.startTimer (&slow));
+	runTicks (90);
+	TIMER_CHECK (jobs >= 8);
+	TIMER_CHECK (task.getWorst () <= 1);
+	TIMER_CHECK (0 == task.getMisses ());
+
+	runTicks (20);				// The slow timer holds the ISR from tick 95 to 130.
+	TIMER_CHECK (task.getWorst () >= 25 && task.getWorst () <= 40);
+	TIMER_CHECK (0 != task.getMisses ());
+	tasks.cancel (task);
+	TIMER_CHECK (0 == timer.getCount ());
+}
+
+/// One-shot tasks are released when due and run once.
+static void testOneShot ()
+{
+	timerTask once (job, 0, 10, 1);
+	timerTask now (job, 0, 0, 1);
+
+	jobs = 0;
+	TIMER_CHECK (tasks.start (once));
+	TIMER_CHECK (tasks.start (now));
+	runTicks (20);
+	TIMER_CHECK (2 == jobs);
+	TIMER_CHECK (1 == once.getRuns () && 1 == now.getRuns ());
+	TIMER_CHECK (once.getWorst () <= 1);
+	TIMER_CHECK (now.getWorst () <= 1);
+	TIMER_CHECK (0 == once.getMisses ());
+	TIMER_CHECK (0 == timer.getCount ());
+}
+
+int main ()
+{
+	testLate (TIMER_RESYNC);
+	testLate (TIMER_SKIP);
+	testLate (TIMER_CATCHUP);
+	testOneShot ();
+	return TimerTestResult ();
+}
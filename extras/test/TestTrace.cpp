@@ -0,0 +1,93 @@
+// flags: -DTIMER_TRACE=1 -DTIMER_ENGINE=0|-DTIMER_TRACE=1 -DTIMER_ENGINE=1|-DTIMER_TRACE=1 -DTIMER_ENGINE=2|-DTIMER_TRACE=1 -DTIMER_ENGINE=0 -DTIMER_TICKLESS=1|-DTIMER_TRACE=1 -DTIMER_ENGINE=1 -DTIMER_TICKLESS=1|-DTIMER_TRACE=1 -DTIMER_ENGINE=2 -DTIMER_TICKLESS=1
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TestTrace.cpp - A trace dump written while the timers go on recording.
+///
+/// A dump holds exactly the records its header counts, in an unbroken run, even
+/// when the recorder fills while the dump is written.  The events lost meanwhile
+/// are reported by the next dump.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "Timer.h"
+#include "TimerTest.h"
+
+Timer timer;
+
+static void count (void *)
+{
+}
+
+/// Collects a dump, and runs the clock on each write as a slow serial port would.
+struct Sink
+{
+	uint8_t bytes [10 + 8 * TIMER_TRACE_SIZE];
+	unsigned size;
+	unsigned ticksPerWrite;
+
+	size_t write (const uint8_t *b, size_t n)
+	{
+		if (size + n <= sizeof (bytes))
+			memcpy (bytes + size, b, n);
+		size += n;
+		TimerSim::advance (ticksPerWrite * 256UL);
+		return n;
+	}
+
+	uint16_t word (const unsigned at) const {return bytes [at] | bytes [at + 1] << 8;}
+};
+
+/// Fill the recorder, then dump it through a sink slow enough to fill it again.
+static void testSlowDump ()
+{
+	timeElement tick (1, 0);
+
+	tick.setCallBack (count);
+	TIMER_CHECK (timer.startTimer (&tick));
+	TimerSim::advance (100 * 256);		// Two events a tick:  the recorder is full.
+
+	Sink slow = {{0}, 0, 4};
+	uint16_t n = timer.dumpTrace (slow);
+
+	TIMER_CHECK (TIMER_TRACE_SIZE == n);
+	TIMER_CHECK (10 + 8U * n == slow.size);
+	TIMER_CHECK (n == slow.word (8));
+
+	// Every tick fired and ended in turn:  no record was replaced by a later one.
+	uint16_t fire = 0;
+
+	for (uint16_t i=0; i<n; i++)
+	{
+		unsigned at = 10 + 8 * i;
+		uint8_t kind = slow.bytes [at + 6];
+		uint16_t t = slow.word (at + 2);
+
+		TIMER_CHECK (TIMER_TRACE_FIRE == kind || TIMER_TRACE_END == kind);
+		if (TIMER_TRACE_FIRE == kind)
+		{
+			if (0 != fire)
+				TIMER_CHECK ((uint16_t) (fire + 1) == t);
+			fire = t;
+		}
+	}
+	timer.cancelTimer (&tick);
+
+	// The events of the ticks the slow writes took were dropped, and counted.
+	Sink fast = {{0}, 0, 0};
+
+	timer.dumpTrace (fast);
+	TIMER_CHECK (0 != fast.word (6));
+	TIMER_CHECK (0 == timer.getCount ());
+}
+
+int main ()
+{
+	testSlowDump ();
+	return TimerTestResult ();
+}
@@ -0,0 +1,55 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerTest.h - Checks shared by the host tests in this directory.
+///
+/// Each test is a program built against TimerSim (see run.sh).  TIMER_CHECK ()
+/// reports a failed condition with its line and goes on; main () returns
+/// TimerTestResult (), which is nonzero if any check failed.  A test that hangs is
+/// stopped by run.sh.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMER_TEST_H
+#define TIMER_TEST_H
+
+#include <cstdio>
+
+static unsigned timerTestChecks, timerTestFailures;
+
+/// Check a condition and report it if false.
+#define TIMER_CHECK(c)	TimerTestCheck ((c), #c, __FILE__, __LINE__)
+
+/// Count a check and report it if it failed.
+/**
+	\param ok is the condition checked.
+	\param text is its source.
+	\param file is the test's source file.
+	\param line is the line of the check.
+*/
+static inline void TimerTestCheck (const bool ok, const char *text, const char *file, const int line)
+{
+	timerTestChecks++;
+	if (!ok)
+	{
+		timerTestFailures++;
+		printf ("%s:%d: check failed: %s\n", file, line, text);
+	}
+}
+
+/// Report the totals.
+/**
+	\return 0 if every check passed, else 1.
+*/
+static inline int TimerTestResult ()
+{
+	printf ("%u checks, %u failed\n", timerTestChecks, timerTestFailures);
+	return 0 != timerTestFailures;
+}
+
+#endif // TIMER_TEST_H
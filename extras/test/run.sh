@@ -0,0 +1,55 @@
+#!/bin/sh
+##############################################################################
+# Build and run the host tests against TimerSim.
+#
+#	cd extras/test && sh run.sh
+#
+# Each Test*.cpp is built with every engine, ticked, tickless and with
+# TIMER_AUTOSCALE, unless its first line names the flags it needs instead
+# ("// flags: ...", one configuration per "|").  A test that does not finish within 60 s fails.
+# Every build is warning-free or fails:  WARN is always added to the flags.
+# CXX and CXXFLAGS are taken from the environment.
+##############################################################################
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+WARN="-Wall -Wextra -Werror"
+ROOT=../..
+SOURCES=$(ls $ROOT/*.cpp)
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+FAILED=0
+
+DEFAULT="-DTIMER_ENGINE=0|-DTIMER_ENGINE=1|-DTIMER_ENGINE=2|\
+-DTIMER_ENGINE=0 -DTIMER_TICKLESS=1|-DTIMER_ENGINE=1 -DTIMER_TICKLESS=1|\
+-DTIMER_ENGINE=2 -DTIMER_TICKLESS=1|\
+-DTIMER_ENGINE=0 -DTIMER_AUTOSCALE=1|-DTIMER_ENGINE=1 -DTIMER_AUTOSCALE=1|\
+-DTIMER_ENGINE=2 -DTIMER_AUTOSCALE=1"
+
+for test in Test*.cpp
+do
+	name=${test%.cpp}
+	configs=$(sed -n '1s|^// flags: ||p' $test)
+	[ -n "$configs" ] || configs=$DEFAULT
+	IFS='|'
+	for flags in $configs
+	do
+		unset IFS
+		if ! $CXX $CXXFLAGS $WARN -I$ROOT -I. $flags -o $OUT/$name $test $SOURCES 2>$OUT/err
+		then
+			echo "$name [$flags]: build failed"
+			cat $OUT/err
+			FAILED=1
+		elif ! timeout 60 $OUT/$name >$OUT/log 2>&1
+		then
+			echo "$name [$flags]: FAILED"
+			cat $OUT/log
+			FAILED=1
+		else
+			echo "$name [$flags]: $(tail -1 $OUT/log)"
+		fi
+		IFS='|'
+	done
+	unset IFS
+done
+exit $FAILED
@@ -0,0 +1,235 @@
+//////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2012 by Byron Watkins <ByronWatkins@clear.net>
+// Timer library for arduino.
+//
+// This file is free software; you can redistribute it and/or modify
+// it under the terms of either the GNU General Public License version 2
+// or the GNU Lesser General Public License version 2.1, both as
+// published by the Free Software Foundation.
+//////////////////////////////////////////////////////////////////////////////////////
+/// TimerTraceDecode.cpp - Host decoder for the dumps of Timer.dumpTrace ().
+///
+/// Capture the serial output of a TIMER_TRACE sketch to a file, for example
+///
+///		stty -F /dev/ttyACM0 raw 115200 && cat /dev/ttyACM0 > trace.bin
+///
+/// and decode it.  Text printed between dumps is skipped; each dump is found by
+/// its header (see TimerTrace.h).  For every timer the decoder reports
+///
+///		fires		callbacks recorded,
+///		late		counts from the start of the tick the timer was due to its
+///					callback:  min / mean / max,
+///		period		counts between successive callbacks:  min / mean / max,
+///		jitter		standard deviation of the period,
+///		callback	counts the callback took:  min / mean / max,
+///
+/// plus its starts and cancels, the ISRs that ran into the next tick and the events
+/// the recorder dropped.  With -t every event is listed as well.  With -f and the
+/// counts per second (F_CPU divided by the prescaler division) times are also
+/// given in microseconds.
+///
+/// Build and run from this directory:
+///
+///		g++ -O2 -I../.. -o TimerTraceDecode TimerTraceDecode.cpp
+///		./TimerTraceDecode [-t] [-f countsPerSecond] trace.bin
+///
+/// Reads standard input when no file is named.  Ticks are unwrapped from their low
+/// 16 bits, so dumps must follow one another within 32768 ticks for the periods
+/// across them to be right.
+//////////////////////////////////////////////////////////////////////////////////////
+
+#include "TimerTrace.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+
+/// Minimum, sum and maximum of a series of counts.
+struct Series
+{
+	Series () : n (0), min (0), max (0), sum (0), squares (0) {}
+
+	/// Account for one value.
+	void Add (const double v)
+	{
+		if (0 == n || v < min) min = v;
+		if (0 == n || v > max) max = v;
+		sum += v;
+		squares += v * v;
+		n++;
+	}
+
+	double Mean () const {return n ? sum / n : 0;}
+	double Deviation () const {return n ? sqrt (fabs (squares / n - Mean () * Mean ())) : 0;}
+
+	unsigned long n;
+	double min, max, sum, squares;
+};
+
+/// What was seen of one timer.
+struct TimerLog
+{
+	TimerLog () : starts (0), cancels (0), lastFire (-1), fireAt (-1) {}
+
+	unsigned long starts, cancels;
+	Series late, period, callback;
+	double lastFire;	///< Time of the previous callback, or -1.
+	double fireAt;		///< Time of the callback awaiting its end, or -1.
+};
+
+static const char *kindName [] = {"?", "start", "cancel", "fire", "end", "lost"};
+
+/// Read a little-endian 16-bit value.
+static unsigned Le16 (const uint8_t *p)
+{
+	return p [0] | p [1] << 8;
+}
+
+/// Print a time in counts, and in microseconds when the count rate is known.
+static void PrintTime (const double counts, const double rate)
+{
+	if (rate > 0)
+		printf ("%12.0f counts %12.1f us", counts, counts * 1e6 / rate);
+	else
+		printf ("%12.0f counts", counts);
+}
+
+int main (int argc, char *argv [])
+{
+	bool timeline = false;
+	double rate = 0;
+	const char *name = 0;
+
+	for (int i=1; i<argc; i++)
+	{
+		if (0 == strcmp (argv [i], "-t"))
+			timeline = true;
+		else if (0 == strcmp (argv [i], "-f") && i + 1 < argc)
+			rate = atof (argv [++i]);
+		else
+			name = argv [i];
+	}
+
+	FILE *in = name ? fopen (name, "rb") : stdin;
+
+	if (!in)
+	{
+		perror (name);
+		return 1;
+	}
+
+	std::vector<uint8_t> bytes;
+	uint8_t chunk [4096];
+	size_t got;
+
+	while (0 != (got = fread (chunk, 1, sizeof (chunk), in)))
+		bytes.insert (bytes.end (), chunk, chunk + got);
+
+	std::map<unsigned, TimerLog> timers;
+	unsigned long dumps = 0, events = 0, dropped = 0, lost = 0;
+	bool started = false;
+	uint32_t tick = 0;
+
+	for (size_t at = 0; at + 10 <= bytes.size (); )
+	{
+		const uint8_t *h = &bytes [at];
+
+		if ('T' != h [0] || 'T' != h [1] || TIMER_TRACE_VERSION != h [2] || 8 != h [3])
+		{
+			at++;				// Not a header; skip text between dumps.
+			continue;
+		}
+
+		unsigned cpt = Le16 (h + 4), n = Le16 (h + 8);
+
+		if (at + 10 + 8 * n > bytes.size ())
+			break;				// The capture ends inside this dump.
+		dumps++;
+		dropped += Le16 (h + 6);
+		if (Le16 (h + 6) && timeline)
+			printf ("--- %u events dropped\n", Le16 (h + 6));
+		at += 10;
+		for (unsigned i=0; i<n; i++, at += 8)
+		{
+			const uint8_t *r = &bytes [at];
+			unsigned id = Le16 (r), kind = r [6], data = r [7];
+
+			if (0 == kind || kind > TIMER_TRACE_LOST)
+				continue;
+			if (!started)
+				tick = Le16 (r + 2);
+			else
+				tick += (int16_t) (Le16 (r + 2) - (uint16_t) tick);
+			started = true;
+			events++;
+
+			double t = (double) tick * cpt + Le16 (r + 4);
+
+			if (timeline)
+			{
+				PrintTime (t, rate);
+				printf ("  tick %10lu  %-6s", (unsigned long) tick, kindName [kind]);
+				if (TIMER_TRACE_LOST != kind)
+					printf ("  timer %04X", id);
+				if (TIMER_TRACE_FIRE == kind)
+					printf ("  %u ticks late", data);
+				if (TIMER_TRACE_END == kind && !data)
+					printf ("  stops");
+				printf ("\n");
+			}
+
+			TimerLog &log = timers [id];
+
+			switch (kind)
+			{
+			case TIMER_TRACE_START:
+				log.starts++;
+				log.lastFire = -1;	// A restart breaks the period.
+				break;
+			case TIMER_TRACE_CANCEL:
+				log.cancels++;
+				log.lastFire = -1;
+				break;
+			case TIMER_TRACE_FIRE:
+				log.late.Add ((double) data * cpt + Le16 (r + 4));
+				if (log.lastFire >= 0)
+					log.period.Add (t - log.lastFire);
+				log.lastFire = log.fireAt = t;
+				break;
+			case TIMER_TRACE_END:
+				if (log.fireAt >= 0)
+					log.callback.Add (t - log.fireAt);
+				log.fireAt = -1;
+				break;
+			case TIMER_TRACE_LOST:
+				lost++;
+				break;
+			}
+		}
+	}
+
+	printf ("%lu dumps, %lu events, %lu dropped, %lu ISRs ran into the next tick\n",
+			  dumps, events, dropped, lost);
+	for (std::map<unsigned, TimerLog>::const_iterator i = timers.begin (); i != timers.end (); ++i)
+	{
+		const TimerLog &log = i->second;
+
+		if (0 == i->first)
+			continue;			// Lost ticks belong to no timer.
+		printf ("\ntimer %04X:  %lu fires, %lu starts, %lu cancels\n",
+				  i->first, log.late.n, log.starts, log.cancels);
+		if (log.late.n)
+			printf ("  late      %10.0f %10.1f %10.0f\n", log.late.min, log.late.Mean (), log.late.max);
+		if (log.period.n)
+		{
+			printf ("  period    %10.0f %10.1f %10.0f\n", log.period.min, log.period.Mean (), log.period.max);
+			printf ("  jitter    %10.1f\n", log.period.Deviation ());
+		}
+		if (log.callback.n)
+			printf ("  callback  %10.0f %10.1f %10.0f\n", log.callback.min, log.callback.Mean (), log.callback.max);
+	}
+	return 0;
+}